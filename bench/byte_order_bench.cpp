@@ -0,0 +1,111 @@
+/*
+ * byte_order_bench.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "byte_order.hpp"
+#include "byte_stream.hpp"
+
+/*
+ * Reference big-endian decode
+ * (a temporary per value assembled with shifts, as read_stream once did)
+ */
+template <class T>
+static T reference_load(const int8_t *data) {
+	uint64_t value = 0;
+	uint8_t *bytes = new uint8_t[sizeof(T)];
+
+	for(unsigned int i = 0; i < sizeof(T); ++i)
+		bytes[i] = data[i];
+	for(unsigned int i = 0; i < sizeof(T); ++i)
+		value |= (uint64_t) bytes[i] << 8 * (sizeof(T) - 1 - i);
+	delete[] bytes;
+	return (T) value;
+}
+
+/*
+ * Returns millions of values read per second
+ */
+static double rate(std::chrono::steady_clock::time_point start, uint64_t count) {
+	return count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 1e6;
+}
+
+/*
+ * Decodes a buffer of short, int & long values (usage: byte_order_bench [count])
+ * (the buffer alternates short+int pairs, followed by longs)
+ */
+int main(int argc, char **argv) {
+	uint64_t count = argc > 1 ? strtoull(argv[1], NULL, 10) : 4000000, pairs = count / 2, longs = count / 2;
+	uint64_t len = pairs * (sizeof(int16_t) + sizeof(int32_t)) + longs * sizeof(int64_t);
+	uint64_t ref_sum = 0, sum = 0, bulk_sum = 0;
+	int16_t s_val;
+	int32_t i_val;
+	int64_t l_val;
+	std::vector<int8_t> buff(len);
+	std::vector<int64_t> bulk(longs);
+	std::chrono::steady_clock::time_point start;
+
+	// fill buffer with pseudo-random bytes (high bits set in every position)
+	for(uint64_t i = 0, seed = 1; i < len; ++i) {
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		buff[i] = (int8_t) (seed >> 56);
+	}
+
+	// per-byte reference decode
+	const int8_t *data = buff.data();
+	start = std::chrono::steady_clock::now();
+	for(uint64_t i = 0; i < pairs; ++i, data += sizeof(int16_t) + sizeof(int32_t))
+		ref_sum += (uint64_t) reference_load<int16_t>(data) + (uint64_t) reference_load<int32_t>(data + sizeof(int16_t));
+	for(uint64_t i = 0; i < longs; ++i, data += sizeof(int64_t))
+		ref_sum += (uint64_t) reference_load<int64_t>(data);
+	std::cout << "per-byte:    " << rate(start, pairs * 2 + longs) << " Mreads/s" << std::endl;
+
+	// stream decode (unaligned load & byte-swap)
+	byte_stream stream(buff.data(), len);
+	start = std::chrono::steady_clock::now();
+	for(uint64_t i = 0; i < pairs; ++i) {
+		stream >> s_val;
+		stream >> i_val;
+		sum += (uint64_t) s_val + (uint64_t) i_val;
+	}
+	for(uint64_t i = 0; i < longs; ++i) {
+		stream >> l_val;
+		sum += (uint64_t) l_val;
+	}
+	std::cout << "byte_stream: " << rate(start, pairs * 2 + longs) << " Mreads/s" << std::endl;
+
+	// bulk decode of the longs
+	start = std::chrono::steady_clock::now();
+	byte_order::load_array<int64_t>(bulk.data(), buff.data() + pairs * (sizeof(int16_t) + sizeof(int32_t)), longs, false);
+	for(uint64_t i = 0; i < longs; ++i)
+		bulk_sum += (uint64_t) bulk[i];
+	std::cout << "load_array:  " << rate(start, longs) << " Mreads/s (longs only)" << std::endl;
+
+	// every decode must agree (sums are unsigned, so they wrap instead of overflowing)
+	for(uint64_t i = 0; i < pairs; ++i)
+		bulk_sum += (uint64_t) reference_load<int16_t>(buff.data() + i * 6) + (uint64_t) reference_load<int32_t>(buff.data() + i * 6 + sizeof(int16_t));
+	if(sum != ref_sum
+			|| bulk_sum != ref_sum) {
+		std::cerr << "decoded values differ" << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
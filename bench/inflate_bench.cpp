@@ -0,0 +1,136 @@
+/*
+ * inflate_bench.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "inflate_backend.hpp"
+#include "region_chunk_info.hpp"
+#include "region_file.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Compressed chunk
+ */
+struct chunk {
+	unsigned int type;
+	std::vector<int8_t> data;
+};
+
+/*
+ * Collects the compressed chunks of a region file
+ */
+static void collect(const std::string &path, std::vector<chunk> &chunks) {
+	region_chunk_info info;
+	region_file file(path);
+	std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+	std::vector<char> raw((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+	// copy each zlib/gzip chunk payload (the size includes the type byte)
+	for(unsigned int z = 0; z < region_file::REGION_SIZE; ++z)
+		for(unsigned int x = 0; x < region_file::REGION_SIZE; ++x) {
+			if(!file.is_filled(x, z))
+				continue;
+			file.get_chunk_info(x, z, info);
+			if((info.get_type() != region_chunk_info::GZIP
+					&& info.get_type() != region_chunk_info::ZLIB)
+					|| !info.get_size()
+					|| (uint64_t) info.get_position() + info.get_size() - 1 > raw.size())
+				continue;
+			chunk ch;
+			ch.type = info.get_type();
+			ch.data.assign(raw.begin() + info.get_position(), raw.begin() + info.get_position() + info.get_size() - 1);
+			chunks.push_back(ch);
+		}
+}
+
+/*
+ * Inflates every chunk with each backend in this build
+ * (usage: inflate_bench [-r repeat] region_file...)
+ */
+int main(int argc, char **argv) {
+	int repeat = 20;
+	uint64_t in_len = 0, out_len;
+	std::vector<chunk> chunks;
+	std::vector<std::vector<int8_t> > expected;
+	std::vector<int8_t> out;
+
+	// collect chunks from all region files
+	try {
+		for(int i = 1; i < argc; ++i) {
+			if(std::string(argv[i]) == "-r"
+					&& i + 1 < argc) {
+				repeat = std::max(atoi(argv[++i]), 1);
+				continue;
+			}
+			collect(argv[i], chunks);
+		}
+	} catch(region_file_exc &exc) {
+		std::cerr << exc.to_string() << std::endl;
+		return EXIT_FAILURE;
+	}
+	if(chunks.empty()) {
+		std::cerr << "usage: " << argv[0] << " [-r repeat] region_file..." << std::endl;
+		return EXIT_FAILURE;
+	}
+	for(unsigned int i = 0; i < chunks.size(); ++i)
+		in_len += chunks.at(i).data.size();
+	std::cout << chunks.size() << " chunks, " << in_len << " compressed bytes, " << repeat << " passes" << std::endl;
+
+	// time each backend over the same chunks (outputs must match zlib)
+	for(unsigned int backend = 0; backend < inflate_backend::BACKEND_COUNT; ++backend) {
+		if(!inflate_backend::available(backend)) {
+			std::cout << inflate_backend::NAME[backend] << ": not built" << std::endl;
+			continue;
+		}
+		inflate_backend *inflater = inflate_backend::create(backend);
+		unsigned int mismatches = 0;
+		try {
+
+			// warm up & check output
+			for(unsigned int i = 0; i < chunks.size(); ++i) {
+				inflater->inflate(chunks.at(i).type, chunks.at(i).data.data(), chunks.at(i).data.size(), out);
+				if(backend == inflate_backend::ZLIB)
+					expected.push_back(out);
+				else if(i >= expected.size()
+						|| out != expected.at(i))
+					++mismatches;
+			}
+
+			// timed passes
+			out_len = 0;
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for(int pass = 0; pass < repeat; ++pass)
+				for(unsigned int i = 0; i < chunks.size(); ++i) {
+					inflater->inflate(chunks.at(i).type, chunks.at(i).data.data(), chunks.at(i).data.size(), out);
+					out_len += out.size();
+				}
+			double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			std::cout << inflate_backend::NAME[backend] << ": " << (sec * 1e6 / (repeat * chunks.size())) << " us/chunk, "
+					<< (out_len / sec / (1 << 20)) << " MiB/s inflated, " << mismatches << " mismatches" << std::endl;
+		} catch(region_file_exc &exc) {
+			std::cerr << inflate_backend::NAME[backend] << ": " << exc.to_string() << std::endl;
+		}
+		delete inflater;
+	}
+	return EXIT_SUCCESS;
+}
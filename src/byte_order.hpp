@@ -0,0 +1,197 @@
+/*
+ * byte_order.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BYTE_ORDER_HPP_
+#define BYTE_ORDER_HPP_
+
+#include <cstdint>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * Unsigned word of a given width
+ */
+template <unsigned int W>
+struct byte_order_word;
+
+template <>
+struct byte_order_word<1> { typedef uint8_t type; };
+
+template <>
+struct byte_order_word<2> { typedef uint16_t type; };
+
+template <>
+struct byte_order_word<4> { typedef uint32_t type; };
+
+template <>
+struct byte_order_word<8> { typedef uint64_t type; };
+
+class byte_order {
+private:
+
+#ifdef __SSE2__
+	/*
+	 * Reverse the bytes of each word within a vector
+	 */
+	static __m128i swap_vector(__m128i value, unsigned int width) {
+
+		// swap bytes within each 16-bit lane
+		value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+
+		// reverse 16-bit lanes within each word
+		switch(width) {
+			case 4:
+				value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+				value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+				break;
+			case 8:
+				value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+				value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+				break;
+		}
+		return value;
+	}
+#endif
+
+public:
+
+	/*
+	 * Host byte order
+	 */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+	static const bool HOST_BIG_ENDIAN = true;
+#else
+	static const bool HOST_BIG_ENDIAN = false;
+#endif
+
+	/*
+	 * Reverse the bytes of a word
+	 */
+	static uint8_t swap(uint8_t value) { return value; }
+
+	/*
+	 * Reverse the bytes of a word
+	 */
+	static uint16_t swap(uint16_t value) { return __builtin_bswap16(value); }
+
+	/*
+	 * Reverse the bytes of a word
+	 */
+	static uint32_t swap(uint32_t value) { return __builtin_bswap32(value); }
+
+	/*
+	 * Reverse the bytes of a word
+	 */
+	static uint64_t swap(uint64_t value) { return __builtin_bswap64(value); }
+
+	/*
+	 * Load a value from a (possibly unaligned) buffer
+	 * (big-endian unless little is set)
+	 */
+	template <class T>
+	static T load(const int8_t *data, bool little) {
+		typedef typename byte_order_word<sizeof(T)>::type word;
+		word raw;
+		T value;
+
+		memcpy(&raw, data, sizeof(T));
+		if(little == HOST_BIG_ENDIAN)
+			raw = swap(raw);
+		memcpy(&value, &raw, sizeof(T));
+		return value;
+	}
+
+	/*
+	 * Store a value into a (possibly unaligned) buffer
+	 * (big-endian unless little is set)
+	 */
+	template <class T>
+	static void store(int8_t *data, T value, bool little) {
+		typedef typename byte_order_word<sizeof(T)>::type word;
+		word raw;
+
+		memcpy(&raw, &value, sizeof(T));
+		if(little == HOST_BIG_ENDIAN)
+			raw = swap(raw);
+		memcpy(data, &raw, sizeof(T));
+	}
+
+	/*
+	 * Load a series of values from a (possibly unaligned) buffer
+	 * (big-endian unless little is set)
+	 */
+	template <class T>
+	static void load_array(T *value, const int8_t *data, uint64_t count, bool little) {
+		memcpy(value, data, count * sizeof(T));
+		if(little == HOST_BIG_ENDIAN)
+			swap_array(value, count);
+	}
+
+	/*
+	 * Store a series of values into a (possibly unaligned) buffer
+	 * (big-endian unless little is set)
+	 */
+	template <class T>
+	static void store_array(int8_t *data, const T *value, uint64_t count, bool little) {
+		memcpy(data, value, count * sizeof(T));
+		if(little == HOST_BIG_ENDIAN)
+			swap_words<sizeof(T)>(data, count);
+	}
+
+	/*
+	 * Reverse the bytes of each word in an array
+	 */
+	template <class T>
+	static void swap_array(T *value, uint64_t count) {
+		swap_words<sizeof(T)>(reinterpret_cast<int8_t *>(value), count);
+	}
+
+	/*
+	 * Reverse the bytes of each W byte word in a (possibly unaligned) buffer
+	 */
+	template <unsigned int W>
+	static void swap_words(int8_t *data, uint64_t count) {
+		typedef typename byte_order_word<W>::type word;
+		uint64_t i = 0;
+		word raw;
+
+		// single byte words are left untouched
+		if(W == 1)
+			return;
+
+#ifdef __SSE2__
+		// swap 16 bytes at a time
+		for(; i + 16 / W <= count; i += 16 / W) {
+			__m128i *vec = reinterpret_cast<__m128i *>(data + i * W);
+			_mm_storeu_si128(vec, swap_vector(_mm_loadu_si128(vec), W));
+		}
+#endif
+
+		// swap remaining words
+		for(; i < count; ++i) {
+			memcpy(&raw, data + i * W, W);
+			raw = swap(raw);
+			memcpy(data + i * W, &raw, W);
+		}
+	}
+};
+
+#endif
@@ -17,6 +17,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <sstream>
 #include "byte_stream.hpp"
 
@@ -26,7 +27,12 @@
 byte_stream::byte_stream(void) {
 	len = 0;
 	pos = 0;
+	base = 0;
+	window = 0;
+	source = NULL;
 	buff = NULL;
+	failed = false;
+	owner = true;
 	swap = NO_SWAP_ENDIAN;
 }
 
@@ -36,49 +42,92 @@ byte_stream::byte_stream(void) {
 byte_stream::byte_stream(const byte_stream &other) {
 	len = other.len;
 	pos = other.pos;
+	base = other.base;
+	window = 0;
+	source = NULL;
+	failed = other.failed;
+	owner = other.owner;
+	swap = other.swap;
+
+	// views share the underlying buffer
+	if(!owner) {
+		buff = other.buff;
+		return;
+	}
 	buff = new int8_t[other.len];
 	if(!buff) {
 		len = 0;
 		pos = 0;
 		return;
 	}
-	for(unsigned int i = 0; i < len; ++i)
-		buff[i] = other.buff[i];
-	swap = other.swap;
+	memcpy(buff, other.buff, len);
 }
 
 /*
  * Byte stream constructor
  */
 byte_stream::byte_stream(const std::string &input) {
+	base = 0;
+	window = 0;
+	source = NULL;
 	len = input.length();
 	pos = 0;
+	failed = false;
+	owner = true;
+	swap = NO_SWAP_ENDIAN;
 	buff = new int8_t[input.length()];
 	if(!buff) {
 		len = 0;
 		pos = 0;
 		return;
 	}
-	for(unsigned int i = 0; i < len; ++i)
-		buff[i] = input[i];
-	swap = NO_SWAP_ENDIAN;
+	memcpy(buff, input.data(), len);
 }
 
 /*
  * Byte stream constructor
  */
 byte_stream::byte_stream(std::vector<int8_t> &input) {
+	base = 0;
+	window = 0;
+	source = NULL;
 	len = input.size();
 	pos = 0;
+	failed = false;
+	owner = true;
+	swap = NO_SWAP_ENDIAN;
 	buff = new int8_t[input.size()];
 	if(!buff) {
 		len = 0;
 		pos = 0;
 		return;
 	}
-	for(unsigned int i = 0; i < len; ++i)
-		buff[i] = input.at(i);
-	swap = NO_SWAP_ENDIAN;
+	memcpy(buff, input.data(), len);
+}
+
+/*
+ * Byte stream constructor
+ * (non-owning view over an existing buffer, no copy is made)
+ */
+byte_stream::byte_stream(int8_t *input, uint64_t len) : buff(input), len(len), pos(0), base(0), window(0), source(NULL), failed(false), owner(false), swap(NO_SWAP_ENDIAN) {
+	if(!buff)
+		this->len = 0;
+}
+
+/*
+ * Byte stream constructor
+ * (streaming, bytes are pulled from source into a fixed window on demand)
+ */
+byte_stream::byte_stream(byte_stream_source &source, uint64_t window) : len(0), pos(0), base(0), window(window), source(&source), failed(false), owner(true), swap(NO_SWAP_ENDIAN) {
+
+	// window must hold the widest value
+	if(this->window < sizeof(int64_t))
+		this->window = sizeof(int64_t);
+	buff = new int8_t[this->window];
+	if(!buff) {
+		this->window = 0;
+		this->source = NULL;
+	}
 }
 
 /*
@@ -90,18 +139,32 @@ byte_stream &byte_stream::operator=(const byte_stream &other) {
 	if(this == &other)
 		return *this;
 
+	// release current buffer
+	if(owner)
+		delete[] buff;
+
 	// set attributes
 	len = other.len;
 	pos = other.pos;
+	base = other.base;
+	window = 0;
+	source = NULL;
+	failed = other.failed;
+	owner = other.owner;
+	swap = other.swap;
+
+	// views share the underlying buffer
+	if(!owner) {
+		buff = other.buff;
+		return *this;
+	}
 	buff = new int8_t[other.len];
 	if(!buff) {
 		len = 0;
 		pos = 0;
 		return *this;
 	}
-	for(unsigned int i = 0; i < len; ++i)
-		buff[i] = other.buff[i];
-	swap = other.swap;
+	memcpy(buff, other.buff, len);
 	return *this;
 }
 
@@ -118,10 +181,8 @@ bool byte_stream::operator==(const byte_stream &other) {
 	if(len != other.len
 			|| pos != other.pos)
 		return false;
-	for(unsigned int i = 0; i < len; ++i)
-		if(buff[i] != other.buff[i])
-			return false;
-	return true;
+	return !len
+			|| !memcmp(buff, other.buff, len);
 }
 
 /*
@@ -133,15 +194,19 @@ bool byte_stream::operator<<(const std::string &input) {
 	int8_t *n_buff = new int8_t[input.length()];
 	if(!n_buff)
 		return false;
-	for(unsigned int i = 0; i < input.length(); ++i)
-		n_buff[i] = input.at(i);
+	memcpy(n_buff, input.data(), input.length());
 
 	// set attributes
-	if(buff)
+	if(owner)
 		delete[] buff;
 	len = input.length();
 	pos = 0;
+	base = 0;
+	window = 0;
+	source = NULL;
 	buff = n_buff;
+	failed = false;
+	owner = true;
 	return true;
 }
 
@@ -167,13 +232,8 @@ bool byte_stream::operator<<(int flag) {
  */
 bool byte_stream::operator>>(int8_t &output) {
 
-	// check if end of stream is reached
-	if(available() == END_OF_STREAM)
-		return END_OF_STREAM;
-
-	// assign char from stream
-	output = buff[pos++];
-	return SUCCESS;
+	// read char from stream
+	return read_stream<int8_t>(output);
 }
 
 /*
@@ -181,12 +241,8 @@ bool byte_stream::operator>>(int8_t &output) {
  */
 bool byte_stream::operator>>(int16_t &output) {
 
-	// check if end of stream is reached
-	if(available() == END_OF_STREAM)
-		return END_OF_STREAM;
-
 	// read short from stream
-	return read_stream<short>(output);
+	return read_stream<int16_t>(output);
 }
 
 /*
@@ -194,12 +250,8 @@ bool byte_stream::operator>>(int16_t &output) {
  */
 bool byte_stream::operator>>(int32_t &output) {
 
-	// check if end of stream is reached
-	if(available() == END_OF_STREAM)
-		return END_OF_STREAM;
-
-	// read short from stream
-	return read_stream<int>(output);
+	// read int from stream
+	return read_stream<int32_t>(output);
 }
 
 /*
@@ -207,12 +259,8 @@ bool byte_stream::operator>>(int32_t &output) {
  */
 bool byte_stream::operator>>(int64_t &output) {
 
-	// check if end of stream is reached
-	if(available() == END_OF_STREAM)
-		return END_OF_STREAM;
-
-	// read short from stream
-	return read_stream<long>(output);
+	// read long from stream
+	return read_stream<int64_t>(output);
 }
 
 /*
@@ -220,12 +268,8 @@ bool byte_stream::operator>>(int64_t &output) {
  */
 bool byte_stream::operator>>(float &output) {
 
-	// check if end of stream is reached
-	if(available() == END_OF_STREAM)
-		return END_OF_STREAM;
-
-	// read short from stream
-	return read_stream_float<float>(output);
+	// read float from stream
+	return read_stream<float>(output);
 }
 
 /*
@@ -233,22 +277,89 @@ bool byte_stream::operator>>(float &output) {
  */
 bool byte_stream::operator>>(double &output) {
 
+	// read double from stream
+	return read_stream<double>(output);
+}
+
+/*
+ * Returns the next byte in the stream without consuming it
+ */
+bool byte_stream::peek(int8_t &output) {
+
 	// check if end of stream is reached
-	if(available() == END_OF_STREAM)
+	if(eof()) {
+		failed = true;
 		return END_OF_STREAM;
+	}
 
-	// read short from stream
-	return read_stream_float<double>(output);
+	// assign char from stream
+	output = buff[pos];
+	return SUCCESS;
 }
 
 /*
- * Returns the available bytes left in the stream
+ * Advances the streams position by a given number of bytes
  */
-unsigned int byte_stream::available(void) {
-	unsigned int remaining = len - pos;
-	if(remaining <= 0)
+bool byte_stream::skip(uint64_t count) {
+
+	// consume streamed bytes one window at a time
+	if(source) {
+		while(count > len - pos) {
+			count -= len - pos;
+			pos = len;
+			if(!refill(1)) {
+				failed = true;
+				return END_OF_STREAM;
+			}
+		}
+	}
+
+	// check for enough bytes
+	if(count > len - pos) {
+		failed = true;
 		return END_OF_STREAM;
-	return remaining;
+	}
+	pos += count;
+	return SUCCESS;
+}
+
+/*
+ * Refills the window until at least count bytes are buffered
+ */
+bool byte_stream::refill(uint64_t count) {
+	uint64_t n;
+
+	// buffered streams have nothing to refill
+	if(!source)
+		return false;
+
+	// move unread bytes to the front of the window
+	if(pos) {
+		memmove(buff, buff + pos, len - pos);
+		base += pos;
+		len -= pos;
+		pos = 0;
+	}
+
+	// pull bytes from source until count are buffered
+	while(len < count) {
+		n = source->read(buff + len, window - len);
+		if(!n)
+			return false;
+		len += n;
+	}
+	return true;
+}
+
+/*
+ * Returns the state of the stream
+ */
+unsigned int byte_stream::status(void) {
+	if(failed)
+		return FAILED;
+	if(eof())
+		return EXHAUSTED;
+	return GOOD;
 }
 
 /*
@@ -258,10 +369,23 @@ std::string byte_stream::to_string(void) {
 	std::stringstream ss;
 
 	// form string representation
-	ss << "[STREAM] " << (good() ? "ACTIVE" : "INACTIVE") << ", size: " << len << ", pos: " << pos;
-	if(available())
+	ss << "[STREAM] ";
+	switch(status()) {
+		case GOOD: ss << "ACTIVE";
+			break;
+		case EXHAUSTED: ss << "EXHAUSTED";
+			break;
+		default: ss << "FAILED";
+			break;
+	}
+	ss << ", size: " << size() << ", pos: " << position();
+	if(!eof())
 		ss << ", curr: " << buff[pos] << " (" << (int) buff[pos] << ")";
 	if(swap)
 		ss << " (SWAP ENDIAN)";
+	if(!owner)
+		ss << " (VIEW)";
+	if(source)
+		ss << " (STREAMING)";
 	return ss.str();
 }
@@ -21,9 +21,12 @@
 #define BYTE_STREAM_HPP_
 
 #include <cstdint>
+#include <algorithm>
 #include <cstdlib>
 #include <string>
 #include <vector>
+#include "byte_order.hpp"
+#include "byte_stream_source.hpp"
 
 class byte_stream {
 private:
@@ -36,7 +39,31 @@ private:
 	/*
 	 * Stream buffer length/position
 	 */
-	unsigned int len, pos;
+	uint64_t len, pos;
+
+	/*
+	 * Streaming window offset/capacity
+	 * (logical offset of the windows first byte)
+	 */
+	uint64_t base, window;
+
+	/*
+	 * Streaming source
+	 * (refills the window on demand, NULL for buffered streams)
+	 */
+	byte_stream_source *source;
+
+	/*
+	 * Stream read failure
+	 * (set when a read runs past the end, cleared on reset)
+	 */
+	bool failed;
+
+	/*
+	 * Stream buffer ownership
+	 * (views do not free their buffer)
+	 */
+	bool owner;
 
 	/*
 	 * Swap endian
@@ -45,65 +72,86 @@ private:
 
 	/*
 	 * Read byte stream into variable
-	 * (char, short, int, long)
+	 * (char, short, int, long, float, double)
 	 */
 	template<class T>
 	unsigned int read_stream(T &var) {
 
-		// assign type T from stream
-		unsigned int width = sizeof(T);
-		char *data = new char[width];
-		for(unsigned int i = 0; i < width; i++) {
-			if(available() == END_OF_STREAM)
-				return END_OF_STREAM;
-			data[i] = buff[pos++];
+		// check for a complete value
+		if(len - pos < sizeof(T)
+				&& !refill(sizeof(T))) {
+			failed = true;
+			return END_OF_STREAM;
 		}
-		if(swap)
-			swap_endian<char>(data, width);
-		var = 0;
-		for(unsigned int i = 0; i < width - 1; i++)
-			var |= data[i] << 8 * ((width - 1) - i);
-		var |= data[width - 1];
-		delete[] data;
+
+		// assign type T from stream (unaligned load & byte-swap)
+		var = byte_order::load<T>(buff + pos, swap);
+		pos += sizeof(T);
 		return SUCCESS;
 	}
 
 	/*
-	 * Read byte stream into variable
-	 * (float, double)
+	 * Read byte stream into values one window at a time
+	 * (streaming streams only)
 	 */
 	template<class T>
-	unsigned int read_stream_float(T &var) {
+	unsigned int read_window(T *output, uint64_t count) {
+		uint64_t n;
+
+		while(count) {
 
-		// assign type T from stream
-		unsigned int width = sizeof(T);
-		char *data = new char[width];
-		for(unsigned int i = 0; i < width; i++) {
-			if(available() == END_OF_STREAM)
+			// check for a complete value
+			if(len - pos < sizeof(T)
+					&& !refill(sizeof(T))) {
+				failed = true;
 				return END_OF_STREAM;
-			data[i] = buff[pos++];
+			}
+
+			// assign buffered values from stream
+			n = std::min(count, (len - pos) / sizeof(T));
+			byte_order::load_array<T>(output, buff + pos, n, swap);
+			pos += n * sizeof(T);
+			output += n;
+			count -= n;
 		}
-		if(swap)
-			swap_endian<char>(data, width);
-		var = atof((char *) data);
-		delete[] data;
 		return SUCCESS;
 	}
 
 	/*
-	 * Convert between endianesses
+	 * Read byte stream into a vector one window at a time
+	 * (streaming streams only, grows with the values read)
 	 */
-	template<class T>
-	void swap_endian(T *&buff, unsigned int len) {
-
-		// create a temp array to hold the reverse
-		T *reverse = new T[len];
-		for(unsigned int i = 0; i < len; i++)
-			reverse[i] = buff[(len - 1) - i];
-		delete[] buff;
-		buff = reverse;
+	template<class T, class A>
+	unsigned int read_window(std::vector<T, A> &output, uint64_t count) {
+		uint64_t n, size;
+
+		output.clear();
+		while(count) {
+
+			// check for a complete value
+			if(len - pos < sizeof(T)
+					&& !refill(sizeof(T))) {
+				failed = true;
+				return END_OF_STREAM;
+			}
+
+			// append buffered values from stream
+			n = std::min(count, (len - pos) / sizeof(T));
+			size = output.size();
+			output.resize(size + n);
+			byte_order::load_array<T>(output.data() + size, buff + pos, n, swap);
+			pos += n * sizeof(T);
+			count -= n;
+		}
+		return SUCCESS;
 	}
 
+	/*
+	 * Refills the window until at least count bytes are buffered
+	 * (returns false for buffered streams or once the source is exhausted)
+	 */
+	bool refill(uint64_t count);
+
 public:
 
 	/*
@@ -112,12 +160,22 @@ public:
 	static const unsigned int END_OF_STREAM = 0;
 	static const unsigned int SUCCESS = 1;
 
+	/*
+	 * Stream states
+	 */
+	enum STATE { GOOD, EXHAUSTED, FAILED };
+
 	/*
 	 * Swap flags
 	 */
 	static const int NO_SWAP_ENDIAN = 0x0;
 	static const int SWAP_ENDIAN = 0x1;
 
+	/*
+	 * Default streaming window size
+	 */
+	static const unsigned int WINDOW_SIZE = 16384;
+
 	/*
 	 * Byte stream constructor
 	 */
@@ -138,10 +196,22 @@ public:
 	 */
 	byte_stream(std::vector<int8_t> &input);
 
+	/*
+	 * Byte stream constructor
+	 * (non-owning view over an existing buffer, no copy is made)
+	 */
+	byte_stream(int8_t *input, uint64_t len);
+
+	/*
+	 * Byte stream constructor
+	 * (streaming, bytes are pulled from source into a fixed window on demand)
+	 */
+	byte_stream(byte_stream_source &source, uint64_t window = WINDOW_SIZE);
+
 	/*
 	 * Byte stream destructor
 	 */
-	virtual ~byte_stream(void) { delete[] buff; }
+	virtual ~byte_stream(void) { if(owner) delete[] buff; }
 
 	/*
 	 * Byte stream assignment
@@ -198,40 +268,134 @@ public:
 	 */
 	bool operator>>(double &output);
 
+	/*
+	 * Byte stream output
+	 * (reads count values in a single pass)
+	 */
+	template<class T>
+	bool read(T *output, uint64_t count) {
+
+		// check for complete values
+		if(count > (len - pos) / sizeof(T)) {
+			if(source)
+				return read_window(output, count);
+			failed = true;
+			return END_OF_STREAM;
+		}
+
+		// assign values from stream (bulk copy & byte-swap)
+		byte_order::load_array<T>(output, buff + pos, count, swap);
+		pos += count * sizeof(T);
+		return SUCCESS;
+	}
+
+	/*
+	 * Byte stream output
+	 * (replaces output with count values read in a single pass)
+	 */
+	template<class T, class A>
+	bool read(std::vector<T, A> &output, uint64_t count) {
+
+		// check for complete values
+		if(count > (len - pos) / sizeof(T)) {
+			if(source)
+				return read_window(output, count);
+			failed = true;
+			return END_OF_STREAM;
+		}
+
+		// single byte values need no swap and are copied directly
+		if(sizeof(T) == 1) {
+			const T *first = reinterpret_cast<const T *>(buff + pos);
+			output.assign(first, first + count);
+		} else {
+			output.resize(count);
+			if(count)
+				byte_order::load_array<T>(output.data(), buff + pos, count, swap);
+		}
+		pos += count * sizeof(T);
+		return SUCCESS;
+	}
+
 	/*
 	 * Returns the available bytes left in the stream
+	 * (bytes left in the window for streaming streams)
 	 */
-	unsigned int available(void);
+	uint64_t available(void) { return len - pos; }
+
+	/*
+	 * Clears the streams read failure
+	 */
+	void clear(void) { failed = false; }
+
+	/*
+	 * Returns the end of stream status
+	 */
+	bool eof(void) { return pos >= len && !refill(1); }
+
+	/*
+	 * Returns the read failure status of the stream
+	 */
+	bool fail(void) { return failed; }
 
 	/*
 	 * Returns the status of the stream
+	 * (no read failure & bytes remaining)
 	 */
-	bool good(void) { return available() != END_OF_STREAM; }
+	bool good(void) { return !failed && !eof(); }
 
 	/*
 	 * Returns the endian swap status of the stream
 	 */
 	bool is_swap(void) { return swap; }
 
+	/*
+	 * Returns the streaming status of the stream
+	 */
+	bool is_streaming(void) { return source != NULL; }
+
+	/*
+	 * Returns the view status of the stream
+	 */
+	bool is_view(void) { return !owner; }
+
+	/*
+	 * Returns the next byte in the stream without consuming it
+	 */
+	bool peek(int8_t &output);
+
 	/*
 	 * Returns the current position of the stream
 	 */
-	unsigned int position(void) { return pos; }
+	uint64_t position(void) { return base + pos; }
 
 	/*
 	 * Returns the entire contents of the stream buffer
+	 * (the current window for streaming streams)
 	 */
 	int8_t *rdbuf(void) { return buff; }
 
 	/*
-	 * Resets the streams position
+	 * Resets the streams position & read failure
+	 * (streaming streams can only rewind to the start of the window)
+	 */
+	void reset(void) { pos = 0; failed = false; }
+
+	/*
+	 * Advances the streams position by a given number of bytes
 	 */
-	void reset(void) { pos = 0; }
+	bool skip(uint64_t count);
 
 	/*
 	 * Returns the streams total size
+	 * (bytes pulled from the source so far for streaming streams)
+	 */
+	uint64_t size(void) { return base + len; }
+
+	/*
+	 * Returns the state of the stream
 	 */
-	unsigned int size(void) { return len; }
+	unsigned int status(void);
 
 	/*
 	 * Returns a string representation of the stream
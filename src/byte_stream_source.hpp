@@ -0,0 +1,45 @@
+/*
+ * byte_stream_source.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BYTE_STREAM_SOURCE_HPP_
+#define BYTE_STREAM_SOURCE_HPP_
+
+#include <cstdint>
+
+class byte_stream_source {
+public:
+
+	/*
+	 * Byte stream source constructor
+	 */
+	byte_stream_source(void) { return; }
+
+	/*
+	 * Byte stream source destructor
+	 */
+	virtual ~byte_stream_source(void) { return; }
+
+	/*
+	 * Reads up to len bytes into a buffer
+	 * (returns the number of bytes read, 0 once the source is exhausted)
+	 */
+	virtual uint64_t read(int8_t *buff, uint64_t len) = 0;
+};
+
+#endif
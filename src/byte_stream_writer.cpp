@@ -0,0 +1,151 @@
+/*
+ * byte_stream_writer.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <sstream>
+#include "byte_stream_writer.hpp"
+
+/*
+ * Byte stream writer constructor
+ */
+byte_stream_writer::byte_stream_writer(void) : buff(NULL), len(0), cap(0), swap(false) {
+	return;
+}
+
+/*
+ * Byte stream writer constructor
+ */
+byte_stream_writer::byte_stream_writer(const byte_stream_writer &other) : buff(NULL), len(0), cap(0), swap(other.swap) {
+
+	// copy contents
+	if(!reserve(other.len))
+		return;
+	memcpy(buff, other.buff, other.len);
+	len = other.len;
+}
+
+/*
+ * Byte stream writer constructor
+ */
+byte_stream_writer::byte_stream_writer(uint64_t capacity) : buff(NULL), len(0), cap(0), swap(false) {
+	reserve(capacity);
+}
+
+/*
+ * Byte stream writer assignment
+ */
+byte_stream_writer &byte_stream_writer::operator=(const byte_stream_writer &other) {
+
+	// check for self
+	if(this == &other)
+		return *this;
+
+	// set attributes
+	len = 0;
+	swap = other.swap;
+	if(!reserve(other.len))
+		return *this;
+	memcpy(buff, other.buff, other.len);
+	len = other.len;
+	return *this;
+}
+
+/*
+ * Byte stream writer equals
+ */
+bool byte_stream_writer::operator==(const byte_stream_writer &other) {
+
+	// check for self
+	if(this == &other)
+		return true;
+
+	// check attributes
+	return len == other.len
+			&& swap == other.swap
+			&& (!len || !memcmp(buff, other.buff, len));
+}
+
+/*
+ * Hands off the stream buffer to the caller (no copy is made)
+ */
+int8_t *byte_stream_writer::release(void) {
+	int8_t *out = buff;
+
+	// reset attributes
+	buff = NULL;
+	len = 0;
+	cap = 0;
+	return out;
+}
+
+/*
+ * Grows the streams buffer capacity to at least a given size
+ */
+bool byte_stream_writer::reserve(uint64_t size) {
+	uint64_t n_cap = cap ? cap : DEFAULT_CAPACITY;
+
+	// check if capacity is sufficient
+	if(size <= cap)
+		return true;
+
+	// double capacity until size fits
+	while(n_cap < size)
+		n_cap *= 2;
+
+	// create new buffer
+	int8_t *n_buff = new int8_t[n_cap];
+	if(!n_buff)
+		return false;
+	if(len)
+		memcpy(n_buff, buff, len);
+
+	// set attributes
+	delete[] buff;
+	buff = n_buff;
+	cap = n_cap;
+	return true;
+}
+
+/*
+ * Write a short length prefix followed by the string bytes
+ */
+bool byte_stream_writer::write_string(const char *input, uint64_t count) {
+
+	// write length followed by string bytes (the length must fit a short)
+	if(count > MAX_STRING_LENGTH
+			|| !reserve(len + sizeof(int16_t) + count)
+			|| !write_stream<int16_t>(count))
+		return false;
+	memcpy(buff + len, input, count);
+	len += count;
+	return true;
+}
+
+/*
+ * Returns a string representation of the stream
+ */
+std::string byte_stream_writer::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[STREAM WRITER] size: " << len << ", capacity: " << cap;
+	if(swap)
+		ss << " (SWAP ENDIAN)";
+	return ss.str();
+}
@@ -0,0 +1,233 @@
+/*
+ * byte_stream_writer.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BYTE_STREAM_WRITER_HPP_
+#define BYTE_STREAM_WRITER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "byte_order.hpp"
+
+class byte_stream_writer {
+private:
+
+	/*
+	 * Stream buffer
+	 */
+	int8_t *buff;
+
+	/*
+	 * Stream buffer length/capacity
+	 */
+	uint64_t len, cap;
+
+	/*
+	 * Swap endian
+	 */
+	bool swap;
+
+	/*
+	 * Write variable into byte stream
+	 * (char, short, int, long, float, double)
+	 */
+	template<class T>
+	bool write_stream(T var) {
+
+		// make room for value
+		if(!reserve(len + sizeof(T)))
+			return false;
+
+		// assign type T to stream (unaligned store & byte-swap)
+		byte_order::store<T>(buff + len, var, swap);
+		len += sizeof(T);
+		return true;
+	}
+
+	/*
+	 * Write a short length prefix followed by the string bytes
+	 * (fails for strings longer than MAX_STRING_LENGTH)
+	 */
+	bool write_string(const char *input, uint64_t count);
+
+public:
+
+	/*
+	 * Initial stream buffer capacity
+	 */
+	static const unsigned int DEFAULT_CAPACITY = 4096;
+
+	/*
+	 * Longest string length
+	 * (lengths are written as a signed short)
+	 */
+	static const unsigned int MAX_STRING_LENGTH = 32767;
+
+	/*
+	 * Byte stream writer constructor
+	 */
+	byte_stream_writer(void);
+
+	/*
+	 * Byte stream writer constructor
+	 */
+	byte_stream_writer(const byte_stream_writer &other);
+
+	/*
+	 * Byte stream writer constructor
+	 */
+	byte_stream_writer(uint64_t capacity);
+
+	/*
+	 * Byte stream writer destructor
+	 */
+	virtual ~byte_stream_writer(void) { delete[] buff; }
+
+	/*
+	 * Byte stream writer assignment
+	 */
+	byte_stream_writer &operator=(const byte_stream_writer &other);
+
+	/*
+	 * Byte stream writer equals
+	 */
+	bool operator==(const byte_stream_writer &other);
+
+	/*
+	 * Byte stream writer not equals
+	 */
+	bool operator!=(const byte_stream_writer &other) { return !(*this == other); }
+
+	/*
+	 * Byte stream writer input
+	 */
+	bool operator<<(int8_t input) { return write_stream<int8_t>(input); }
+
+	/*
+	 * Byte stream writer input
+	 */
+	bool operator<<(int16_t input) { return write_stream<int16_t>(input); }
+
+	/*
+	 * Byte stream writer input
+	 */
+	bool operator<<(int32_t input) { return write_stream<int32_t>(input); }
+
+	/*
+	 * Byte stream writer input
+	 */
+	bool operator<<(int64_t input) { return write_stream<int64_t>(input); }
+
+	/*
+	 * Byte stream writer input
+	 */
+	bool operator<<(float input) { return write_stream<float>(input); }
+
+	/*
+	 * Byte stream writer input
+	 */
+	bool operator<<(double input) { return write_stream<double>(input); }
+
+	/*
+	 * Byte stream writer input
+	 * (short length prefix followed by the string bytes, at most
+	 * MAX_STRING_LENGTH bytes)
+	 */
+	bool operator<<(const std::string &input) { return write_string(input.data(), input.length()); }
+
+	/*
+	 * Byte stream writer input
+	 * (strings with another allocator, e.g. tag names)
+	 */
+	template<class A>
+	bool operator<<(const std::basic_string<char, std::char_traits<char>, A> &input) { return write_string(input.data(), input.length()); }
+
+	/*
+	 * Byte stream writer input
+	 * (writes count values in a single pass)
+	 */
+	template<class T>
+	bool write(const T *input, uint64_t count) {
+
+		// make room for values
+		if(!reserve(len + count * sizeof(T)))
+			return false;
+
+		// assign values to stream (bulk copy & byte-swap)
+		if(count)
+			byte_order::store_array<T>(buff + len, input, count, swap);
+		len += count * sizeof(T);
+		return true;
+	}
+
+	/*
+	 * Byte stream writer input
+	 * (writes all values in a single pass)
+	 */
+	template<class T, class A>
+	bool write(const std::vector<T, A> &input) { return write(input.data(), input.size()); }
+
+	/*
+	 * Returns the streams buffer capacity
+	 */
+	uint64_t capacity(void) { return cap; }
+
+	/*
+	 * Discards the streams contents (capacity is kept)
+	 */
+	void clear(void) { len = 0; }
+
+	/*
+	 * Returns the endian swap status of the stream
+	 */
+	bool is_swap(void) { return swap; }
+
+	/*
+	 * Returns the entire contents of the stream buffer
+	 */
+	int8_t *rdbuf(void) { return buff; }
+
+	/*
+	 * Hands off the stream buffer to the caller (no copy is made)
+	 * (the caller takes ownership and must free it with delete[])
+	 */
+	int8_t *release(void);
+
+	/*
+	 * Grows the streams buffer capacity to at least a given size
+	 */
+	bool reserve(uint64_t size);
+
+	/*
+	 * Sets the endian swap status of the stream
+	 */
+	void set_swap(bool swap) { this->swap = swap; }
+
+	/*
+	 * Returns the streams total size
+	 */
+	uint64_t size(void) { return len; }
+
+	/*
+	 * Returns a string representation of the stream
+	 */
+	std::string to_string(void);
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * inflate_backend.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "inflate_backend.hpp"
+#include "inflate_context.hpp"
+#include "libdeflate_context.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Source over a fully inflated buffer
+ * (used by backends without streaming support)
+ */
+class inflate_buffer : public byte_stream_source {
+public:
+
+	/*
+	 * Inflated data/position
+	 */
+	std::vector<int8_t> data;
+	uint64_t pos;
+
+	/*
+	 * Inflate buffer constructor
+	 */
+	inflate_buffer(void) : pos(0) { return; }
+
+	/*
+	 * Copies up to len bytes into a buffer
+	 */
+	uint64_t read(int8_t *buff, uint64_t len) {
+		len = std::min<uint64_t>(len, data.size() - pos);
+		if(len)
+			memcpy(buff, data.data() + pos, len);
+		pos += len;
+		return len;
+	}
+};
+
+/*
+ * Backend names
+ */
+const std::string inflate_backend::NAME[BACKEND_COUNT] = {
+		"zlib",
+		"libdeflate",
+};
+
+/*
+ * Environment variable selecting the shared backend by name
+ */
+const std::string inflate_backend::ENVIRONMENT = "NBT_INFLATE_BACKEND";
+
+/*
+ * Returns the availability of a backend in this build
+ */
+bool inflate_backend::available(unsigned int backend) {
+	switch(backend) {
+		case ZLIB: return true;
+#ifdef NBT_LIBDEFLATE
+		case LIBDEFLATE: return true;
+#endif
+		default: return false;
+	}
+}
+
+/*
+ * Creates a new backend (the caller takes ownership)
+ */
+inflate_backend *inflate_backend::create(unsigned int backend) {
+	inflate_backend *result = NULL;
+
+	// create backend based off type
+	switch(backend) {
+		case ZLIB: result = new inflate_context;
+			break;
+#ifdef NBT_LIBDEFLATE
+		case LIBDEFLATE: result = new libdeflate_context;
+			break;
+#endif
+		default: throw region_file_exc(region_file_exc::UNSUPPORTED_COMPRESSION, backend < BACKEND_COUNT ? NAME[backend] : "unknown backend");
+			break;
+	}
+	if(!result)
+		throw region_file_exc(region_file_exc::ALLOC_FAIL);
+	return result;
+}
+
+/*
+ * Creates the process-wide backend
+ */
+inflate_backend *inflate_backend::create_shared(void) {
+	unsigned int type = available(LIBDEFLATE) ? LIBDEFLATE : ZLIB;
+
+	// allow the environment to override the default
+	const char *name = getenv(ENVIRONMENT.c_str());
+	for(unsigned int i = 0; name && i < BACKEND_COUNT; ++i)
+		if(NAME[i] == name
+				&& available(i))
+			type = i;
+	return create(type);
+}
+
+/*
+ * Opens a streaming inflater over a given compression type
+ */
+byte_stream_source *inflate_backend::open(unsigned int type, const int8_t *in, uint64_t len) {
+	inflate_buffer *result = new inflate_buffer;
+	if(!result)
+		throw region_file_exc(region_file_exc::ALLOC_FAIL);
+
+	// inflate whole input up front
+	try {
+		inflate(type, in, len, result->data);
+	} catch(...) {
+		delete result;
+		throw;
+	}
+	return result;
+}
+
+/*
+ * Returns the process-wide backend
+ */
+inflate_backend &inflate_backend::shared(void) {
+	static inflate_backend *backend = create_shared();
+	return *backend;
+}
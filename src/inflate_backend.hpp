@@ -0,0 +1,117 @@
+/*
+ * inflate_backend.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INFLATE_BACKEND_HPP_
+#define INFLATE_BACKEND_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "byte_stream_source.hpp"
+
+class inflate_backend {
+private:
+
+	/*
+	 * Inflate backend constructor
+	 * (backends own decompressor state and are not copyable)
+	 */
+	inflate_backend(const inflate_backend &other);
+
+	/*
+	 * Inflate backend assignment
+	 */
+	inflate_backend &operator=(const inflate_backend &other);
+
+	/*
+	 * Creates the process-wide backend
+	 */
+	static inflate_backend *create_shared(void);
+
+public:
+
+	/*
+	 * Supported backends
+	 */
+	enum BACKEND { ZLIB, LIBDEFLATE, };
+	static const std::string NAME[];
+	static const unsigned int BACKEND_COUNT = 2;
+
+	/*
+	 * Environment variable selecting the shared backend by name
+	 */
+	static const std::string ENVIRONMENT;
+
+	/*
+	 * Inflation minimum output size & expected compression ratio
+	 */
+	static const unsigned int MIN_SIZE = 65536;
+	static const unsigned int RATIO = 4;
+
+	/*
+	 * Inflate backend constructor
+	 */
+	inflate_backend(void) { return; }
+
+	/*
+	 * Inflate backend destructor
+	 */
+	virtual ~inflate_backend(void) { return; }
+
+	/*
+	 * Returns the availability of a backend in this build
+	 */
+	static bool available(unsigned int backend);
+
+	/*
+	 * Creates a new backend (the caller takes ownership)
+	 */
+	static inflate_backend *create(unsigned int backend);
+
+	/*
+	 * Returns a backends type
+	 */
+	virtual unsigned int get_backend(void) = 0;
+
+	/*
+	 * Inflation routine for a given compression type (GZIP/ZLIB)
+	 * (inflates directly into out, which is resized to the inflated size)
+	 */
+	virtual void inflate(unsigned int type, const int8_t *in, uint64_t len, std::vector<int8_t> &out) = 0;
+
+	/*
+	 * Opens a streaming inflater over a given compression type (GZIP/ZLIB)
+	 * (the caller takes ownership, in must outlive the source)
+	 * (backends without streaming support inflate the whole input up front)
+	 */
+	virtual byte_stream_source *open(unsigned int type, const int8_t *in, uint64_t len);
+
+	/*
+	 * Returns the process-wide backend
+	 * (the fastest available, unless overridden by the environment)
+	 */
+	static inflate_backend &shared(void);
+
+	/*
+	 * Returns a string representation of a backend
+	 */
+	virtual std::string to_string(void) = 0;
+};
+
+#endif
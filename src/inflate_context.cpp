@@ -0,0 +1,169 @@
+/*
+ * inflate_context.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sstream>
+#include "inflate_context.hpp"
+#include "inflate_stream.hpp"
+#include "region_chunk_info.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Inflate context destructor
+ */
+inflate_context::~inflate_context(void) {
+
+	// free all idle zlib streams
+	for(unsigned int i = 0; i < pool.size(); ++i) {
+		inflateEnd(pool.at(i));
+		delete pool.at(i);
+	}
+	pool.clear();
+}
+
+/*
+ * Takes an idle zlib stream from the pool (or creates one)
+ */
+z_stream *inflate_context::acquire(void) {
+	z_stream *str = NULL;
+
+	// reuse an idle stream if one exists
+	{
+		std::lock_guard<std::mutex> guard(pool_lock);
+		if(!pool.empty()) {
+			str = pool.back();
+			pool.pop_back();
+			return str;
+		}
+	}
+
+	// setup a new zlib object
+	str = new z_stream;
+	if(!str)
+		throw region_file_exc(region_file_exc::ALLOC_FAIL);
+	str->zalloc = Z_NULL;
+	str->zfree = Z_NULL;
+	str->opaque = Z_NULL;
+	str->avail_in = 0;
+	str->next_in = Z_NULL;
+	if(inflateInit2(str, WINDOW_BITS) != Z_OK) {
+		delete str;
+		throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "inflateInit2");
+	}
+	return str;
+}
+
+/*
+ * ZLib inflation routine
+ */
+void inflate_context::inflate(unsigned int type, const int8_t *in, uint64_t len, std::vector<int8_t> &out) {
+	int ret;
+	uint64_t size;
+	z_stream *str = NULL;
+
+	// both formats share the same (auto-detecting) streams
+	if(type != region_chunk_info::GZIP
+			&& type != region_chunk_info::ZLIB)
+		throw region_file_exc(region_file_exc::UNSUPPORTED_COMPRESSION, type);
+
+	// presize output from the input length (only the estimate is zero-filled,
+	// larger chunks grow below)
+	out.resize(std::max<uint64_t>(len * RATIO, MIN_SIZE));
+
+	// setup input
+	str = acquire();
+	str->avail_in = len;
+	str->next_in = (Bytef *) in;
+
+	// inflate directly into output, doubling it whenever it fills
+	try {
+		do {
+			if(str->total_out == out.size())
+				out.resize(out.size() * 2);
+			str->next_out = (Bytef *) out.data() + str->total_out;
+			str->avail_out = out.size() - str->total_out;
+			ret = ::inflate(str, Z_NO_FLUSH);
+		} while(ret == Z_OK
+				|| (ret == Z_BUF_ERROR && !str->avail_out));
+	} catch(...) {
+		release(str);
+		throw;
+	}
+
+	// trim output to inflated size
+	size = str->total_out;
+	release(str);
+	if(ret != Z_STREAM_END)
+		throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, ret);
+	out.resize(size);
+}
+
+/*
+ * Opens a streaming zlib inflater over a given compression type
+ */
+byte_stream_source *inflate_context::open(unsigned int type, const int8_t *in, uint64_t len) {
+	byte_stream_source *result = NULL;
+	z_stream *str = NULL;
+
+	// both formats share the same (auto-detecting) streams
+	if(type != region_chunk_info::GZIP
+			&& type != region_chunk_info::ZLIB)
+		throw region_file_exc(region_file_exc::UNSUPPORTED_COMPRESSION, type);
+	str = acquire();
+	result = new inflate_stream(*this, str, in, len);
+	if(!result) {
+		release(str);
+		throw region_file_exc(region_file_exc::ALLOC_FAIL);
+	}
+	return result;
+}
+
+/*
+ * Resets a zlib stream and returns it to the pool
+ */
+void inflate_context::release(z_stream *str) {
+
+	// drop streams that fail to reset
+	if(inflateReset(str) != Z_OK) {
+		inflateEnd(str);
+		delete str;
+		return;
+	}
+	std::lock_guard<std::mutex> guard(pool_lock);
+	pool.push_back(str);
+}
+
+/*
+ * Returns the number of idle zlib streams
+ */
+unsigned int inflate_context::size(void) {
+	std::lock_guard<std::mutex> guard(pool_lock);
+	return pool.size();
+}
+
+/*
+ * Returns a string representation of an inflate context
+ */
+std::string inflate_context::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[INFLATE] " << NAME[ZLIB] << ", idle: " << size();
+	return ss.str();
+}
@@ -0,0 +1,104 @@
+/*
+ * inflate_context.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INFLATE_CONTEXT_HPP_
+#define INFLATE_CONTEXT_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "inflate_backend.hpp"
+
+class inflate_context : public inflate_backend {
+private:
+
+	/*
+	 * Streams return their zlib stream to the pool
+	 */
+	friend class inflate_stream;
+
+	/*
+	 * ZLib window bits (gzip & zlib header auto-detection)
+	 */
+	static const int WINDOW_BITS = 32 + MAX_WBITS;
+
+	/*
+	 * Idle zlib streams
+	 * (initialized once, reset between chunks)
+	 */
+	std::vector<z_stream *> pool;
+
+	/*
+	 * Pool guard
+	 */
+	std::mutex pool_lock;
+
+	/*
+	 * Takes an idle zlib stream from the pool (or creates one)
+	 */
+	z_stream *acquire(void);
+
+	/*
+	 * Resets a zlib stream and returns it to the pool
+	 */
+	void release(z_stream *str);
+
+public:
+
+	/*
+	 * Inflate context constructor
+	 */
+	inflate_context(void) { return; }
+
+	/*
+	 * Inflate context destructor
+	 */
+	virtual ~inflate_context(void);
+
+	/*
+	 * Returns a backends type
+	 */
+	unsigned int get_backend(void) { return ZLIB; }
+
+	/*
+	 * ZLib inflation routine for a given compression type (GZIP/ZLIB)
+	 * (inflates directly into out, which is resized to the inflated size)
+	 */
+	void inflate(unsigned int type, const int8_t *in, uint64_t len, std::vector<int8_t> &out);
+
+	/*
+	 * Opens a streaming zlib inflater over a given compression type (GZIP/ZLIB)
+	 * (the caller takes ownership, in must outlive the source)
+	 */
+	byte_stream_source *open(unsigned int type, const int8_t *in, uint64_t len);
+
+	/*
+	 * Returns the number of idle zlib streams
+	 */
+	unsigned int size(void);
+
+	/*
+	 * Returns a string representation of an inflate context
+	 */
+	std::string to_string(void);
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * inflate_stream.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "inflate_context.hpp"
+#include "inflate_stream.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Inflate stream constructor
+ */
+inflate_stream::inflate_stream(inflate_context &context, z_stream *str, const int8_t *in, uint64_t len) : context(context), str(str), done(false) {
+
+	// setup input
+	str->avail_in = len;
+	str->next_in = (Bytef *) in;
+}
+
+/*
+ * Inflate stream destructor
+ */
+inflate_stream::~inflate_stream(void) {
+	context.release(str);
+}
+
+/*
+ * Inflates up to len bytes into a buffer
+ */
+uint64_t inflate_stream::read(int8_t *buff, uint64_t len) {
+	int ret;
+
+	// check if end of stream is reached
+	if(done
+			|| !len)
+		return 0;
+
+	// inflate until some output is produced
+	str->next_out = (Bytef *) buff;
+	str->avail_out = len;
+	do {
+		ret = ::inflate(str, Z_NO_FLUSH);
+	} while(ret == Z_OK
+			&& str->avail_out == len);
+
+	// truncated or corrupt input is an error, not an end of stream
+	if(ret == Z_STREAM_END)
+		done = true;
+	else if(ret != Z_OK)
+		throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, ret);
+	return len - str->avail_out;
+}
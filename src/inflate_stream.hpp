@@ -0,0 +1,79 @@
+/*
+ * inflate_stream.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INFLATE_STREAM_HPP_
+#define INFLATE_STREAM_HPP_
+
+#include <cstdint>
+#include <zlib.h>
+#include "byte_stream_source.hpp"
+
+class inflate_context;
+
+class inflate_stream : public byte_stream_source {
+private:
+
+	/*
+	 * Owning inflate context
+	 */
+	inflate_context &context;
+
+	/*
+	 * Pooled zlib stream
+	 * (returned to the context once the stream is destroyed)
+	 */
+	z_stream *str;
+
+	/*
+	 * End of compressed stream reached
+	 */
+	bool done;
+
+	/*
+	 * Inflate stream constructor
+	 * (streams hold pooled state and are not copyable)
+	 */
+	inflate_stream(const inflate_stream &other);
+
+	/*
+	 * Inflate stream assignment
+	 */
+	inflate_stream &operator=(const inflate_stream &other);
+
+public:
+
+	/*
+	 * Inflate stream constructor
+	 * (input must outlive the stream)
+	 */
+	inflate_stream(inflate_context &context, z_stream *str, const int8_t *in, uint64_t len);
+
+	/*
+	 * Inflate stream destructor
+	 */
+	virtual ~inflate_stream(void);
+
+	/*
+	 * Inflates up to len bytes into a buffer
+	 * (returns the number of bytes inflated, 0 once the stream ends)
+	 */
+	uint64_t read(int8_t *buff, uint64_t len);
+};
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * libdeflate_context.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef NBT_LIBDEFLATE
+
+#include <algorithm>
+#include <libdeflate.h>
+#include <sstream>
+#include "libdeflate_context.hpp"
+#include "region_chunk_info.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Libdeflate context destructor
+ */
+libdeflate_context::~libdeflate_context(void) {
+
+	// free all idle decompressors
+	for(unsigned int i = 0; i < pool.size(); ++i)
+		libdeflate_free_decompressor(pool.at(i));
+	pool.clear();
+}
+
+/*
+ * Takes an idle decompressor from the pool (or creates one)
+ */
+libdeflate_decompressor *libdeflate_context::acquire(void) {
+	libdeflate_decompressor *dec = NULL;
+
+	// reuse an idle decompressor if one exists
+	{
+		std::lock_guard<std::mutex> guard(pool_lock);
+		if(!pool.empty()) {
+			dec = pool.back();
+			pool.pop_back();
+			return dec;
+		}
+	}
+
+	// create a new decompressor
+	dec = libdeflate_alloc_decompressor();
+	if(!dec)
+		throw region_file_exc(region_file_exc::ALLOC_FAIL);
+	return dec;
+}
+
+/*
+ * One-shot inflation routine
+ */
+void libdeflate_context::inflate(unsigned int type, const int8_t *in, uint64_t len, std::vector<int8_t> &out) {
+	size_t size = 0;
+	libdeflate_result ret;
+	libdeflate_decompressor *dec = NULL;
+	libdeflate_result (*decompress)(libdeflate_decompressor *, const void *, size_t, void *, size_t, size_t *) = NULL;
+
+	// select decoder based off type
+	switch(type) {
+		case region_chunk_info::GZIP: decompress = libdeflate_gzip_decompress;
+			break;
+		case region_chunk_info::ZLIB: decompress = libdeflate_zlib_decompress;
+			break;
+		default: throw region_file_exc(region_file_exc::UNSUPPORTED_COMPRESSION, type);
+			break;
+	}
+
+	// presize output from the input length (only the estimate is zero-filled,
+	// larger chunks grow below)
+	out.resize(std::max<uint64_t>(len * RATIO, MIN_SIZE));
+
+	// inflate the whole input at once, doubling output until it fits
+	dec = acquire();
+	try {
+		while((ret = decompress(dec, in, len, out.data(), out.size(), &size)) == LIBDEFLATE_INSUFFICIENT_SPACE)
+			out.resize(out.size() * 2);
+	} catch(...) {
+		release(dec);
+		throw;
+	}
+
+	// trim output to inflated size
+	release(dec);
+	if(ret != LIBDEFLATE_SUCCESS)
+		throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, ret);
+	out.resize(size);
+}
+
+/*
+ * Returns a decompressor to the pool
+ */
+void libdeflate_context::release(libdeflate_decompressor *dec) {
+	std::lock_guard<std::mutex> guard(pool_lock);
+	pool.push_back(dec);
+}
+
+/*
+ * Returns the number of idle decompressors
+ */
+unsigned int libdeflate_context::size(void) {
+	std::lock_guard<std::mutex> guard(pool_lock);
+	return pool.size();
+}
+
+/*
+ * Returns a string representation of a libdeflate context
+ */
+std::string libdeflate_context::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[INFLATE] " << NAME[LIBDEFLATE] << ", idle: " << size();
+	return ss.str();
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * libdeflate_context.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBDEFLATE_CONTEXT_HPP_
+#define LIBDEFLATE_CONTEXT_HPP_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "inflate_backend.hpp"
+
+struct libdeflate_decompressor;
+
+class libdeflate_context : public inflate_backend {
+private:
+
+	/*
+	 * Idle libdeflate decompressors
+	 */
+	std::vector<libdeflate_decompressor *> pool;
+
+	/*
+	 * Pool guard
+	 */
+	std::mutex pool_lock;
+
+	/*
+	 * Takes an idle decompressor from the pool (or creates one)
+	 */
+	libdeflate_decompressor *acquire(void);
+
+	/*
+	 * Returns a decompressor to the pool
+	 */
+	void release(libdeflate_decompressor *dec);
+
+public:
+
+	/*
+	 * Libdeflate context constructor
+	 */
+	libdeflate_context(void) { return; }
+
+	/*
+	 * Libdeflate context destructor
+	 */
+	virtual ~libdeflate_context(void);
+
+	/*
+	 * Returns a backends type
+	 */
+	unsigned int get_backend(void) { return LIBDEFLATE; }
+
+	/*
+	 * One-shot inflation routine
+	 * (inflates the whole input at once directly into out, which is resized to the inflated size)
+	 */
+	void inflate(unsigned int type, const int8_t *in, uint64_t len, std::vector<int8_t> &out);
+
+	/*
+	 * Returns the number of idle decompressors
+	 */
+	unsigned int size(void);
+
+	/*
+	 * Returns a string representation of a libdeflate context
+	 */
+	std::string to_string(void);
+};
+
+#endif
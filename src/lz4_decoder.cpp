@@ -0,0 +1,145 @@
+/*
+ * lz4_decoder.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include "byte_order.hpp"
+#include "lz4_decoder.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Block magic
+ */
+const std::string lz4_decoder::MAGIC = "LZ4Block";
+
+/*
+ * Decodes a series of framed lz4 blocks
+ */
+void lz4_decoder::decode(const int8_t *in, uint64_t len, std::vector<int8_t> &out) {
+	uint8_t method;
+	uint64_t pos = 0, size;
+	uint32_t comp_len, orig_len;
+
+	// decode blocks until the end mark (an empty block) is reached
+	out.clear();
+	for(;;) {
+
+		// check for a complete block header
+		if(len - pos < HEADER_SIZE
+				|| memcmp(in + pos, MAGIC.data(), MAGIC.length()))
+			throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 block header");
+		method = in[pos + MAGIC.length()] & 0xf0;
+		comp_len = byte_order::load<uint32_t>(in + pos + 9, true);
+		orig_len = byte_order::load<uint32_t>(in + pos + 13, true);
+		pos += HEADER_SIZE;
+		if(!orig_len)
+			break;
+
+		// check for a complete block body & a possible original length
+		// (bounds the output before it is allocated)
+		if(comp_len > len - pos
+				|| orig_len > MAX_BLOCK_SIZE
+				|| orig_len > (uint64_t) comp_len * MAX_RATIO + 16)
+			throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 block length");
+		size = out.size();
+		out.resize(size + orig_len);
+
+		// decode block (the xxhash checksum is not verified)
+		switch(method) {
+			case METHOD_RAW:
+				if(comp_len != orig_len)
+					throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 raw block length");
+				memcpy(out.data() + size, in + pos, orig_len);
+				break;
+			case METHOD_LZ4:
+				decode_block(reinterpret_cast<const uint8_t *>(in + pos), comp_len, out.data() + size, orig_len);
+				break;
+			default: throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 block method");
+				break;
+		}
+		pos += comp_len;
+	}
+}
+
+/*
+ * Decodes a single raw lz4 block into a buffer of exactly len bytes
+ */
+void lz4_decoder::decode_block(const uint8_t *in, uint64_t in_len, int8_t *out, uint64_t out_len) {
+	uint8_t token;
+	uint64_t ip = 0, op = 0, count, offset;
+
+	while(ip < in_len) {
+		token = in[ip++];
+
+		// literal length (extended by runs of 255)
+		count = token >> 4;
+		if(count == 0xf) {
+			do {
+				if(ip >= in_len)
+					throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 literal length");
+				count += in[ip];
+			} while(in[ip++] == 0xff);
+		}
+
+		// copy literals
+		if(count > in_len - ip
+				|| count > out_len - op)
+			throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 literal overrun");
+		memcpy(out + op, in + ip, count);
+		ip += count;
+		op += count;
+
+		// last sequence has no match
+		if(ip == in_len)
+			break;
+
+		// match offset
+		if(in_len - ip < 2)
+			throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 match offset");
+		offset = in[ip] | (in[ip + 1] << 8);
+		ip += 2;
+		if(!offset
+				|| offset > op)
+			throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 match offset");
+
+		// match length (extended by runs of 255)
+		count = token & 0xf;
+		if(count == 0xf) {
+			do {
+				if(ip >= in_len)
+					throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 match length");
+				count += in[ip];
+			} while(in[ip++] == 0xff);
+		}
+		count += MIN_MATCH;
+		if(count > out_len - op)
+			throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 match overrun");
+
+		// copy match (overlapping matches repeat the last offset bytes)
+		if(offset >= count)
+			memcpy(out + op, out + op - offset, count);
+		else
+			for(uint64_t i = 0; i < count; ++i)
+				out[op + i] = out[op + i - offset];
+		op += count;
+	}
+
+	// check for a completely decoded block
+	if(op != out_len)
+		throw region_file_exc(region_file_exc::DECOMPRESS_FAIL, "lz4 block size");
+}
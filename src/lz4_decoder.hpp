@@ -0,0 +1,78 @@
+/*
+ * lz4_decoder.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LZ4_DECODER_HPP_
+#define LZ4_DECODER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class lz4_decoder {
+private:
+
+	/*
+	 * Block header size
+	 * (magic, token, compressed/original length & checksum)
+	 */
+	static const unsigned int HEADER_SIZE = 21;
+
+	/*
+	 * Largest original block length
+	 * (lz4-java framing allows blocks of up to 32 MiB)
+	 */
+	static const unsigned int MAX_BLOCK_SIZE = 1 << 25;
+
+	/*
+	 * Largest expansion of a compressed block
+	 * (each input byte extends a match by at most 255 bytes)
+	 */
+	static const unsigned int MAX_RATIO = 255;
+
+	/*
+	 * Block methods
+	 */
+	static const unsigned int METHOD_RAW = 0x10;
+	static const unsigned int METHOD_LZ4 = 0x20;
+
+	/*
+	 * Minimum match length
+	 */
+	static const unsigned int MIN_MATCH = 4;
+
+	/*
+	 * Decodes a single raw lz4 block into a buffer of exactly len bytes
+	 */
+	static void decode_block(const uint8_t *in, uint64_t in_len, int8_t *out, uint64_t out_len);
+
+public:
+
+	/*
+	 * Block magic
+	 */
+	static const std::string MAGIC;
+
+	/*
+	 * Decodes a series of framed lz4 blocks (lz4-java block stream)
+	 * (out is replaced with the decoded data)
+	 */
+	static void decode(const int8_t *in, uint64_t len, std::vector<int8_t> &out);
+};
+
+#endif
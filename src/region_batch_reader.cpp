@@ -0,0 +1,450 @@
+/*
+ * region_batch_reader.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "byte_order.hpp"
+#include "region_batch_reader.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Backend names
+ */
+const std::string region_batch_reader::NAME[BACKEND_COUNT] = {
+		"io_uring",
+		"thread pool",
+};
+
+/*
+ * Region batch reader constructor
+ */
+region_batch_reader::region_batch_reader(unsigned int depth, unsigned int threads, bool uring) : backend(URING), in_flight(0), depth(std::max(depth, 1U)),
+		ring_fd(-1), sq_ring(NULL), cq_ring(NULL), sq_ring_len(0), cq_ring_len(0), sqes(NULL), sqes_len(0), stopping(false) {
+
+	// prefer io_uring, fall back to a pread thread pool
+	if(uring
+			&& uring_setup())
+		return;
+	backend = THREAD_POOL;
+	for(unsigned int i = 0; i < std::max(threads, 1U); ++i)
+		workers.push_back(std::thread(&region_batch_reader::work, this));
+}
+
+/*
+ * Region batch reader destructor
+ */
+region_batch_reader::~region_batch_reader(void) {
+
+	// stop workers
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	work_ready.notify_all();
+	for(unsigned int i = 0; i < workers.size(); ++i)
+		workers.at(i).join();
+
+	// wait for the kernel to release in-flight buffers
+	while(backend == URING
+			&& in_flight) {
+		try {
+			reap(true);
+		} catch(...) {
+			break;
+		}
+	}
+	uring_teardown();
+
+	// free outstanding requests
+	for(unsigned int i = 0; i < queued.size(); ++i)
+		delete queued.at(i);
+	for(unsigned int i = 0; i < completed.size(); ++i)
+		delete completed.at(i);
+}
+
+/*
+ * Completes a request into a fetched chunk
+ */
+void region_batch_reader::complete(request *req, chunk &value) {
+	uint64_t comp_size, have, offset = req->offset;
+	std::vector<int8_t> &data = req->value.data;
+
+	// check for a complete chunk header
+	if(req->result < (int64_t) region_file::CHUNK_HEADER_SIZE) {
+		delete req;
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, offset);
+	}
+	req->value.info.set_size(byte_order::load<uint32_t>(data.data(), false));
+	req->value.info.set_type((uint8_t) data[sizeof(int32_t)]);
+
+	// chunk length includes the compression type byte
+	comp_size = req->value.info.get_size() ? req->value.info.get_size() - 1 : 0;
+	have = req->result - region_file::CHUNK_HEADER_SIZE;
+
+	// chunks larger than their sectors need the remainder
+	if(comp_size > have) {
+		data.resize(region_file::CHUNK_HEADER_SIZE + comp_size);
+		req->offset += req->result;
+		req->vec.iov_base = data.data() + req->result;
+		req->vec.iov_len = comp_size - have;
+		read_span(req);
+		if(req->result != (int64_t) (comp_size - have)) {
+			delete req;
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, offset);
+		}
+	}
+
+	// keep the payload only
+	data.erase(data.begin(), data.begin() + region_file::CHUNK_HEADER_SIZE);
+	data.resize(comp_size);
+	value.region = req->value.region;
+	value.x = req->value.x;
+	value.z = req->value.z;
+	value.info = req->value.info;
+	value.data.swap(data);
+	delete req;
+}
+
+/*
+ * Returns the next fetched chunk, in completion order
+ */
+bool region_batch_reader::next(chunk &value) {
+	request *req = NULL;
+
+	// io_uring completions are collected by the caller
+	if(backend == URING) {
+		while(completed.empty()) {
+			if(!in_flight
+					&& queued.empty())
+				return false;
+			submit_queued();
+			reap(true);
+		}
+		req = completed.front();
+		completed.pop_front();
+		complete(req, value);
+		return true;
+	}
+
+	// thread pool completions are pushed by workers
+	std::unique_lock<std::mutex> guard(lock);
+	while(completed.empty()) {
+		if(!in_flight
+				&& queued.empty())
+			return false;
+		work_done.wait(guard);
+	}
+	req = completed.front();
+	completed.pop_front();
+	guard.unlock();
+	complete(req, value);
+	return true;
+}
+
+/*
+ * Reads a requests sector span with positioned reads
+ */
+void region_batch_reader::read_span(request *req) {
+	ssize_t count;
+	int8_t *data = static_cast<int8_t *>(req->vec.iov_base);
+	uint64_t len = req->vec.iov_len;
+
+	req->result = 0;
+	while((uint64_t) req->result < len) {
+		count = pread(req->fd, data + req->result, len - req->result, req->offset + req->result);
+		if(count < 0
+				&& errno == EINTR)
+			continue;
+		if(count < 0) {
+			req->result = -errno;
+			return;
+		}
+		if(!count)
+			break;
+		req->result += count;
+	}
+}
+
+/*
+ * Collects io_uring completions
+ */
+void region_batch_reader::reap(bool wait) {
+	int ret;
+	request *req = NULL;
+	unsigned int head = *cq_head, tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+	// wait for at least one completion
+	while(wait
+			&& head == tail) {
+		ret = syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+		if(ret < 0
+				&& errno != EINTR)
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, "io_uring_enter");
+		tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+	}
+
+	// move completions to the completed queue
+	for(; head != tail; ++head) {
+		struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+		req = reinterpret_cast<request *>(cqe->user_data);
+		req->result = cqe->res;
+		completed.push_back(req);
+		--in_flight;
+	}
+	__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+}
+
+/*
+ * Returns the number of outstanding chunk reads
+ */
+unsigned int region_batch_reader::size(void) {
+	std::lock_guard<std::mutex> guard(lock);
+	return queued.size() + in_flight + completed.size();
+}
+
+/*
+ * Queues a read for a chunk at a given x, z coord
+ */
+void region_batch_reader::submit(region_file &region, unsigned int x, unsigned int z) {
+	uint64_t span;
+	request *req = NULL;
+
+	// check if x, z coord is filled
+	if(!region.is_filled(x, z)) {
+		unsigned int coord[] = {x, z};
+		std::vector<unsigned int> coord_vec(coord, coord + 2);
+		throw region_file_exc(region_file_exc::UNFILLED_CHUNK, coord_vec);
+	}
+
+	// setup request over the chunks whole sector span
+	req = new request;
+	if(!req)
+		throw region_file_exc(region_file_exc::ALLOC_FAIL);
+	req->value.region = &region;
+	req->value.x = x;
+	req->value.z = z;
+	req->value.info = region.info[x + z * region_file::REGION_SIZE];
+	req->fd = region.fd;
+	req->offset = req->value.info.get_position() - region_file::CHUNK_HEADER_SIZE;
+	req->result = 0;
+	span = std::max<uint64_t>((uint64_t) req->value.info.get_sectors() * region_file::SECTOR_SIZE, region_file::CHUNK_HEADER_SIZE);
+	req->value.data.resize(span);
+	req->vec.iov_base = req->value.data.data();
+	req->vec.iov_len = span;
+
+	// mapped regions complete immediately (covering chunks larger than their sectors)
+	if(region.map) {
+		if(req->offset + region_file::CHUNK_HEADER_SIZE <= region.map_len) {
+			span = std::max<uint64_t>(span, byte_order::load<uint32_t>(region.map + req->offset, false) + sizeof(int32_t));
+			req->result = std::min<uint64_t>(span, region.map_len - req->offset);
+			req->value.data.resize(req->result);
+			memcpy(req->value.data.data(), region.map + req->offset, req->result);
+		}
+		std::lock_guard<std::mutex> guard(lock);
+		completed.push_back(req);
+		work_done.notify_one();
+		return;
+	}
+
+	// queue request for the backend
+	if(backend == URING) {
+		queued.push_back(req);
+		submit_queued();
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		queued.push_back(req);
+	}
+	work_ready.notify_one();
+}
+
+/*
+ * Submits queued requests to io_uring, up to depth in flight
+ */
+void region_batch_reader::submit_queued(void) {
+	int ret;
+	request *req = NULL;
+	unsigned int count = 0, index, tail = *sq_tail;
+
+	// fill submission entries
+	while(!queued.empty()
+			&& in_flight < depth) {
+		req = queued.front();
+		queued.pop_front();
+		index = tail & *sq_mask;
+		struct io_uring_sqe *sqe = &sqes[index];
+		memset(sqe, 0, sizeof(struct io_uring_sqe));
+		sqe->opcode = IORING_OP_READV;
+		sqe->fd = req->fd;
+		sqe->off = req->offset;
+		sqe->addr = reinterpret_cast<uint64_t>(&req->vec);
+		sqe->len = 1;
+		sqe->user_data = reinterpret_cast<uint64_t>(req);
+		sq_array[index] = index;
+		++tail;
+		++count;
+		++in_flight;
+	}
+	if(!count)
+		return;
+
+	// publish entries & submit them
+	__atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+	while(count) {
+		ret = syscall(__NR_io_uring_enter, ring_fd, count, 0, 0, NULL, 0);
+		if(ret < 0) {
+			if(errno == EINTR)
+				continue;
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, "io_uring_enter");
+		}
+		count -= std::min<unsigned int>(ret, count);
+	}
+}
+
+/*
+ * Sets up io_uring
+ */
+bool region_batch_reader::uring_setup(void) {
+	struct io_uring_params params;
+	uint8_t *sq, *cq;
+
+	// create ring
+	memset(&params, 0, sizeof(params));
+	ring_fd = syscall(__NR_io_uring_setup, depth, &params);
+	if(ring_fd < 0) {
+		ring_fd = -1;
+		return false;
+	}
+
+	// map submission & completion rings (shared when supported)
+	sq_ring_len = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	cq_ring_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+		sq_ring_len = cq_ring_len = std::max(sq_ring_len, cq_ring_len);
+	sq_ring = mmap(NULL, sq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+	if(sq_ring == MAP_FAILED) {
+		sq_ring = NULL;
+		uring_teardown();
+		return false;
+	}
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+		cq_ring = sq_ring;
+	else {
+		cq_ring = mmap(NULL, cq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+		if(cq_ring == MAP_FAILED) {
+			cq_ring = NULL;
+			uring_teardown();
+			return false;
+		}
+	}
+
+	// map submission entries
+	sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+	sqes = static_cast<struct io_uring_sqe *>(mmap(NULL, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+	if(sqes == MAP_FAILED) {
+		sqes = NULL;
+		uring_teardown();
+		return false;
+	}
+
+	// locate ring fields
+	sq = static_cast<uint8_t *>(sq_ring);
+	cq = static_cast<uint8_t *>(cq_ring);
+	sq_head = reinterpret_cast<unsigned int *>(sq + params.sq_off.head);
+	sq_tail = reinterpret_cast<unsigned int *>(sq + params.sq_off.tail);
+	sq_mask = reinterpret_cast<unsigned int *>(sq + params.sq_off.ring_mask);
+	sq_array = reinterpret_cast<unsigned int *>(sq + params.sq_off.array);
+	cq_head = reinterpret_cast<unsigned int *>(cq + params.cq_off.head);
+	cq_tail = reinterpret_cast<unsigned int *>(cq + params.cq_off.tail);
+	cq_mask = reinterpret_cast<unsigned int *>(cq + params.cq_off.ring_mask);
+	cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+	depth = std::min(depth, params.sq_entries);
+	return true;
+}
+
+/*
+ * Tears down io_uring
+ */
+void region_batch_reader::uring_teardown(void) {
+	if(sqes)
+		munmap(sqes, sqes_len);
+	if(cq_ring
+			&& cq_ring != sq_ring)
+		munmap(cq_ring, cq_ring_len);
+	if(sq_ring)
+		munmap(sq_ring, sq_ring_len);
+	if(ring_fd >= 0)
+		close(ring_fd);
+	sqes = NULL;
+	cq_ring = NULL;
+	sq_ring = NULL;
+	ring_fd = -1;
+}
+
+/*
+ * Thread pool worker routine
+ */
+void region_batch_reader::work(void) {
+	request *req = NULL;
+
+	for(;;) {
+
+		// wait for a queued request
+		std::unique_lock<std::mutex> guard(lock);
+		while(queued.empty()
+				&& !stopping)
+			work_ready.wait(guard);
+		if(stopping)
+			return;
+		req = queued.front();
+		queued.pop_front();
+		++in_flight;
+		guard.unlock();
+
+		// read outside the lock & hand back
+		read_span(req);
+		guard.lock();
+		--in_flight;
+		completed.push_back(req);
+		work_done.notify_all();
+	}
+}
+
+/*
+ * Returns a string representation of a region batch reader
+ */
+std::string region_batch_reader::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[BATCH] " << NAME[backend];
+	if(backend == URING)
+		ss << ", depth: " << depth;
+	else
+		ss << ", threads: " << workers.size();
+	ss << ", outstanding: " << size();
+	return ss.str();
+}
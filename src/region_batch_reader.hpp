@@ -0,0 +1,248 @@
+/*
+ * region_batch_reader.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGION_BATCH_READER_HPP_
+#define REGION_BATCH_READER_HPP_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+#include "region_chunk_info.hpp"
+#include "region_file.hpp"
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+class region_batch_reader {
+public:
+
+	/*
+	 * Fetched region chunk
+	 * (compressed payload, see region_file::get_chunk_tag)
+	 */
+	class chunk {
+	public:
+
+		/*
+		 * Source region file
+		 */
+		region_file *region;
+
+		/*
+		 * Chunk coord
+		 */
+		unsigned int x, z;
+
+		/*
+		 * Chunk information (length & compression type filled in)
+		 */
+		region_chunk_info info;
+
+		/*
+		 * Compressed chunk payload
+		 */
+		std::vector<int8_t> data;
+
+		/*
+		 * Chunk constructor
+		 */
+		chunk(void) : region(NULL), x(0), z(0) { return; }
+	};
+
+private:
+
+	/*
+	 * Read request
+	 */
+	class request {
+	public:
+
+		/*
+		 * Requested chunk (data holds the read sector span)
+		 */
+		chunk value;
+
+		/*
+		 * Region file descriptor & chunk sector offset
+		 */
+		int fd;
+		uint64_t offset;
+
+		/*
+		 * Bytes read, or a negative errno
+		 */
+		int64_t result;
+
+		/*
+		 * Read vector (io_uring)
+		 */
+		struct iovec vec;
+	};
+
+	/*
+	 * Backend in use
+	 */
+	unsigned int backend;
+
+	/*
+	 * Requests queued (not yet submitted) & completed (not yet returned)
+	 */
+	std::deque<request *> queued, completed;
+
+	/*
+	 * Requests submitted & not yet completed
+	 */
+	unsigned int in_flight;
+
+	/*
+	 * Maximum requests in flight
+	 */
+	unsigned int depth;
+
+	/*
+	 * io_uring descriptor & ring mappings
+	 */
+	int ring_fd;
+	void *sq_ring, *cq_ring;
+	size_t sq_ring_len, cq_ring_len;
+	struct io_uring_sqe *sqes;
+	size_t sqes_len;
+
+	/*
+	 * io_uring ring fields
+	 */
+	unsigned int *sq_head, *sq_tail, *sq_mask, *sq_array;
+	unsigned int *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_cqe *cqes;
+
+	/*
+	 * Thread pool workers & guards
+	 * (workers take queued requests & push completed ones)
+	 */
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable work_ready, work_done;
+	bool stopping;
+
+	/*
+	 * Region batch reader constructor
+	 * (readers own rings & threads and are not copyable)
+	 */
+	region_batch_reader(const region_batch_reader &other);
+
+	/*
+	 * Region batch reader assignment
+	 */
+	region_batch_reader &operator=(const region_batch_reader &other);
+
+	/*
+	 * Completes a request into a fetched chunk
+	 */
+	void complete(request *req, chunk &value);
+
+	/*
+	 * Reads a requests sector span with positioned reads
+	 */
+	static void read_span(request *req);
+
+	/*
+	 * Collects io_uring completions (waiting for at least one if wait is set)
+	 */
+	void reap(bool wait);
+
+	/*
+	 * Submits queued requests to io_uring, up to depth in flight
+	 */
+	void submit_queued(void);
+
+	/*
+	 * Sets up io_uring, returns false if unavailable
+	 */
+	bool uring_setup(void);
+
+	/*
+	 * Tears down io_uring
+	 */
+	void uring_teardown(void);
+
+	/*
+	 * Thread pool worker routine
+	 */
+	void work(void);
+
+public:
+
+	/*
+	 * Supported backends
+	 */
+	enum BACKEND { URING, THREAD_POOL, };
+	static const std::string NAME[];
+	static const unsigned int BACKEND_COUNT = 2;
+
+	/*
+	 * Default queue depth & worker count
+	 */
+	static const unsigned int DEFAULT_DEPTH = 64;
+	static const unsigned int DEFAULT_THREADS = 4;
+
+	/*
+	 * Region batch reader constructor
+	 * (io_uring when available, otherwise a pread thread pool)
+	 */
+	region_batch_reader(unsigned int depth = DEFAULT_DEPTH, unsigned int threads = DEFAULT_THREADS, bool uring = true);
+
+	/*
+	 * Region batch reader destructor
+	 */
+	virtual ~region_batch_reader(void);
+
+	/*
+	 * Returns the backend in use
+	 */
+	unsigned int get_backend(void) { return backend; }
+
+	/*
+	 * Returns the next fetched chunk, in completion order
+	 * (blocks until one arrives, returns false once nothing is outstanding)
+	 */
+	bool next(chunk &value);
+
+	/*
+	 * Returns the number of outstanding chunk reads
+	 */
+	unsigned int size(void);
+
+	/*
+	 * Queues a read for a chunk at a given x, z coord
+	 * (the region file must outlive the read)
+	 */
+	void submit(region_file &region, unsigned int x, unsigned int z);
+
+	/*
+	 * Returns a string representation of a region batch reader
+	 */
+	std::string to_string(void);
+};
+
+#endif
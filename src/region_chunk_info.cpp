@@ -28,6 +28,7 @@ region_chunk_info::region_chunk_info(void) {
 	size = 0;
 	modified = 0;
 	type = UNDEFINED;
+	sectors = 0;
 }
 
 /*
@@ -38,6 +39,7 @@ region_chunk_info::region_chunk_info(const region_chunk_info &other) {
 	size = other.size;
 	modified = other.modified;
 	type = other.type;
+	sectors = other.sectors;
 }
 
 /*
@@ -54,6 +56,7 @@ region_chunk_info &region_chunk_info::operator=(const region_chunk_info &other)
 	size = other.size;
 	modified = other.modified;
 	type = other.type;
+	sectors = other.sectors;
 	return *this;
 }
 
@@ -70,7 +73,8 @@ bool region_chunk_info::operator==(const region_chunk_info &other) {
 	return pos == other.pos
 			&& size == other.size
 			&& modified == other.modified
-			&& type == other.type;
+			&& type == other.type
+			&& sectors == other.sectors;
 }
 
 /*
@@ -86,9 +90,13 @@ std::string region_chunk_info::to_string(void) {
 			break;
 		case ZLIB: ss << "ZLIB";
 			break;
+		case UNCOMPRESSED: ss << "UNCOMPRESSED";
+			break;
+		case LZ4: ss << "LZ4";
+			break;
 		default: ss << "UNDEFINED";
 			break;
 	}
-	ss << ", timestamp: " << modified << ", size: " << size << ", pos: " << pos;
+	ss << ", timestamp: " << modified << ", size: " << size << ", pos: " << pos << ", sectors: " << sectors;
 	return ss.str();
 }
@@ -36,12 +36,17 @@ private:
 	 */
 	unsigned int pos, size, type;
 
+	/*
+	 * Chunk sector count
+	 */
+	unsigned int sectors;
+
 public:
 
 	/*
 	 * Compression types
 	 */
-	enum COMPRESSION { UNDEFINED, GZIP, ZLIB };
+	enum COMPRESSION { UNDEFINED, GZIP, ZLIB, UNCOMPRESSED, LZ4 };
 
 	/*
 	 * Region chunk info constructor
@@ -56,7 +61,7 @@ public:
 	/*
 	 * Region chunk info constructor
 	 */
-	region_chunk_info(unsigned int type, unsigned int size, unsigned int pos, time_t modified) : modified(modified), pos(pos), size(size), type(type) { return; }
+	region_chunk_info(unsigned int type, unsigned int size, unsigned int pos, time_t modified, unsigned int sectors = 0) : modified(modified), pos(pos), size(size), type(type), sectors(sectors) { return; }
 
 	/*
 	 * Region chunk info destructor
@@ -94,6 +99,11 @@ public:
 	 */
 	unsigned int get_position(void) { return pos; }
 
+	/*
+	 * Returns a region chunk info's sector count
+	 */
+	unsigned int get_sectors(void) { return sectors; }
+
 	/*
 	 * Returns a region chunk info's size
 	 */
@@ -114,6 +124,11 @@ public:
 	 */
 	void set_position(unsigned int pos) { this->pos = pos; }
 
+	/*
+	 * Sets a region chunk info's sector count
+	 */
+	void set_sectors(unsigned int sectors) { this->sectors = sectors; }
+
 	/*
 	 * Sets a region chunk info's size
 	 */
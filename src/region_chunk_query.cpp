@@ -0,0 +1,283 @@
+/*
+ * region_chunk_query.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <sstream>
+#include "region_chunk_query.hpp"
+#include "region_file_exc.hpp"
+
+/*
+ * Step type names
+ */
+const std::string region_chunk_query::NAME[STEP_COUNT] = {
+		"CHILD",
+		"ALL",
+		"INDEX",
+		"MATCH STRING",
+		"MATCH NUMBER",
+};
+
+/*
+ * Region chunk query constructor
+ */
+region_chunk_query::region_chunk_query(const std::string &expression) : expression(expression) {
+	compile();
+}
+
+/*
+ * Compiles the query expression into steps
+ */
+void region_chunk_query::compile(void) {
+	size_t pos = 0, end, len = expression.size();
+	char *last;
+	step st;
+
+	// parse dot separated names, each followed by any number of filters
+	// (names are looked up, not pooled, see resolve)
+	steps.clear();
+	while(pos < len) {
+
+		// compound child by name
+		end = expression.find_first_of(".[", pos);
+		if(end == std::string::npos)
+			end = len;
+		if(end > pos) {
+			st = step();
+			st.type = CHILD;
+			st.key = expression.substr(pos, end - pos);
+			st.name = tag_name_pool::find(st.key);
+			steps.push_back(st);
+		} else if(end == len
+				|| expression[end] != '[')
+			throw region_file_exc(region_file_exc::INVALID_QUERY, expression);
+		pos = end;
+
+		// filters
+		while(pos < len
+				&& expression[pos] == '[') {
+			st = step();
+			end = expression.find(']', ++pos);
+			if(end == std::string::npos
+					|| end == pos)
+				throw region_file_exc(region_file_exc::INVALID_QUERY, expression);
+
+			// every child
+			if(expression.compare(pos, end - pos, "*") == 0)
+				st.type = ALL;
+
+			// list element by index
+			else if(expression.find_first_not_of("0123456789", pos) == end) {
+				st.type = INDEX;
+				st.index = strtoul(expression.c_str() + pos, NULL, 10);
+			}
+
+			// list elements whose child equals a value
+			else {
+				size_t eq = expression.find('=', pos);
+				if(eq == std::string::npos
+						|| eq == pos
+						|| eq > end)
+					throw region_file_exc(region_file_exc::INVALID_QUERY, expression);
+				st.key = expression.substr(pos, eq - pos);
+				st.name = tag_name_pool::find(st.key);
+				if(expression[eq + 1] == '"') {
+
+					// quoted strings may hold a closing bracket
+					end = expression.find('"', eq + 2);
+					if(end == std::string::npos
+							|| end + 1 >= len
+							|| expression[end + 1] != ']')
+						throw region_file_exc(region_file_exc::INVALID_QUERY, expression);
+					st.type = MATCH_STRING;
+					st.text = expression.substr(eq + 2, end - eq - 2);
+					++end;
+				} else {
+					st.type = MATCH_NUMBER;
+					st.number = strtod(expression.c_str() + eq + 1, &last);
+					if(eq + 1 == end
+							|| last != expression.c_str() + end)
+						throw region_file_exc(region_file_exc::INVALID_QUERY, expression);
+				}
+			}
+			steps.push_back(st);
+			pos = end + 1;
+		}
+
+		// next name
+		if(pos < len) {
+			if(expression[pos] != '.'
+					|| pos + 1 == len)
+				throw region_file_exc(region_file_exc::INVALID_QUERY, expression);
+			++pos;
+		}
+	}
+}
+
+/*
+ * Returns true if a list element matches a steps key & value
+ */
+bool region_chunk_query::matches(const step &st, generic_tag *tag) const {
+	generic_tag *key;
+
+	// check for a keyed compound
+	if(tag->get_type() != generic_tag::COMPOUND
+			|| !(key = static_cast<compound_tag *>(tag)->find(st.name)))
+		return false;
+
+	// compare value based off type
+	switch(key->get_type()) {
+		case generic_tag::STRING:
+			return st.type == MATCH_STRING
+					&& static_cast<string_tag *>(key)->value.size() == st.text.size()
+					&& !static_cast<string_tag *>(key)->value.compare(0, st.text.size(), st.text.data(), st.text.size());
+		case generic_tag::BYTE:
+			return st.type == MATCH_NUMBER && static_cast<byte_tag *>(key)->value == st.number;
+		case generic_tag::SHORT:
+			return st.type == MATCH_NUMBER && static_cast<short_tag *>(key)->value == st.number;
+		case generic_tag::INT:
+			return st.type == MATCH_NUMBER && static_cast<int_tag *>(key)->value == st.number;
+		case generic_tag::LONG:
+			return st.type == MATCH_NUMBER && static_cast<long_tag *>(key)->value == st.number;
+		case generic_tag::FLOAT:
+			return st.type == MATCH_NUMBER && static_cast<float_tag *>(key)->value == st.number;
+		case generic_tag::DOUBLE:
+			return st.type == MATCH_NUMBER && static_cast<double_tag *>(key)->value == st.number;
+		default: return false;
+	}
+}
+
+/*
+ * Resolves step names pooled since compiling
+ */
+bool region_chunk_query::resolve(void) {
+	bool result = true;
+
+	for(unsigned int i = 0; i < steps.size(); ++i)
+		if(steps[i].name == tag_name_pool::NONE
+				&& (steps[i].name = tag_name_pool::find(steps[i].key)) == tag_name_pool::NONE)
+			result = false;
+	return result;
+}
+
+/*
+ * Returns true if every step name is pooled
+ */
+bool region_chunk_query::resolved(void) const {
+	for(unsigned int i = 0; i < steps.size(); ++i)
+		if(steps[i].name == tag_name_pool::NONE)
+			return false;
+	return true;
+}
+
+/*
+ * Collects the tags matching the query in a chunk tag
+ */
+void region_chunk_query::run(region_chunk_tag &tag, std::vector<generic_tag *> &results) const {
+	results.clear();
+	if(!tag.get_root_tag())
+		return;
+
+	// names pooled since compiling are resolved on a copy (tags only hold
+	// pooled names, so a name that is still not pooled matches nothing)
+	if(!resolved()) {
+		region_chunk_query query(*this);
+		if(query.resolve())
+			query.run(tag.get_root_tag(), 0, results);
+	} else
+		run(tag.get_root_tag(), 0, results);
+}
+
+/*
+ * Collects the tags matching the steps from a given step onward
+ */
+void region_chunk_query::run(generic_tag *tag, unsigned int op, std::vector<generic_tag *> &results) const {
+	generic_tag *child;
+
+	// every step matched
+	if(op == steps.size()) {
+		results.push_back(tag);
+		return;
+	}
+	const step &st = steps[op];
+
+	// descend into children based off step type
+	if(tag->get_type() == generic_tag::COMPOUND) {
+		compound_tag *cmp_tag = static_cast<compound_tag *>(tag);
+		switch(st.type) {
+			case CHILD:
+				if((child = cmp_tag->find(st.name)))
+					run(child, op + 1, results);
+				break;
+			case ALL:
+				for(unsigned int i = 0; i < cmp_tag->size(); ++i)
+					run(cmp_tag->at(i), op + 1, results);
+				break;
+		}
+	} else if(tag->get_type() == generic_tag::LIST) {
+		list_tag *lst_tag = static_cast<list_tag *>(tag);
+		switch(st.type) {
+			case ALL:
+				for(unsigned int i = 0; i < lst_tag->size(); ++i)
+					run(lst_tag->at(i), op + 1, results);
+				break;
+			case INDEX:
+				if(st.index < lst_tag->size())
+					run(lst_tag->at(st.index), op + 1, results);
+				break;
+			case MATCH_STRING:
+			case MATCH_NUMBER:
+				for(unsigned int i = 0; i < lst_tag->size(); ++i)
+					if(matches(st, lst_tag->at(i)))
+						run(lst_tag->at(i), op + 1, results);
+				break;
+		}
+	}
+}
+
+/*
+ * Sets & compiles the query expression
+ */
+void region_chunk_query::set_expression(const std::string &expression) {
+	this->expression = expression;
+	compile();
+}
+
+/*
+ * Returns a string representation of a region chunk query
+ */
+std::string region_chunk_query::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[QUERY] " << expression << " (" << steps.size() << ")";
+	for(unsigned int i = 0; i < steps.size(); ++i) {
+		ss << std::endl << "\t" << NAME[steps[i].type];
+		switch(steps[i].type) {
+			case CHILD: ss << " " << steps[i].key;
+				break;
+			case INDEX: ss << " " << steps[i].index;
+				break;
+			case MATCH_STRING: ss << " " << steps[i].key << "=\"" << steps[i].text << "\"";
+				break;
+			case MATCH_NUMBER: ss << " " << steps[i].key << "=" << steps[i].number;
+				break;
+		}
+	}
+	return ss.str();
+}
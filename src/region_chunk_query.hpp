@@ -0,0 +1,158 @@
+/*
+ * region_chunk_query.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGION_CHUNK_QUERY_HPP_
+#define REGION_CHUNK_QUERY_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "region_chunk_tag.hpp"
+
+class region_chunk_query {
+private:
+
+	/*
+	 * Region files read only the subtrees a query touches
+	 */
+	friend class region_file;
+
+	/*
+	 * Query step
+	 * (each step descends one level of the tree)
+	 */
+	class step {
+	public:
+
+		/*
+		 * Step type
+		 */
+		unsigned int type;
+
+		/*
+		 * Child name/match key
+		 * (pooled name id, NONE until the name is pooled)
+		 */
+		uint32_t name;
+		std::string key;
+
+		/*
+		 * Element index
+		 */
+		uint32_t index;
+
+		/*
+		 * Match value
+		 */
+		std::string text;
+		double number;
+	};
+
+	/*
+	 * Query expression
+	 */
+	std::string expression;
+
+	/*
+	 * Compiled query steps
+	 */
+	std::vector<step> steps;
+
+	/*
+	 * Compiles the query expression into steps
+	 */
+	void compile(void);
+
+	/*
+	 * Returns true if a list element matches a steps key & value
+	 */
+	bool matches(const step &st, generic_tag *tag) const;
+
+	/*
+	 * Resolves step names pooled since compiling
+	 * (returns false if a name is still not pooled)
+	 */
+	bool resolve(void);
+
+	/*
+	 * Returns true if every step name is pooled
+	 */
+	bool resolved(void) const;
+
+	/*
+	 * Collects the tags matching the steps from a given step onward
+	 */
+	void run(generic_tag *tag, unsigned int op, std::vector<generic_tag *> &results) const;
+
+public:
+
+	/*
+	 * Supported step types
+	 * (compound child by name, every child, list element by index,
+	 * list elements whose child equals a string/number)
+	 */
+	enum STEP { CHILD, ALL, INDEX, MATCH_STRING, MATCH_NUMBER, };
+	static const std::string NAME[];
+	static const unsigned int STEP_COUNT = 5;
+
+	/*
+	 * Region chunk query constructor
+	 * (matches the root tag)
+	 */
+	region_chunk_query(void) { return; }
+
+	/*
+	 * Region chunk query constructor
+	 * (e.g. Level.Entities[*].Pos, Level.TileEntities[id="Chest"], Level.Sections[3].Blocks)
+	 */
+	region_chunk_query(const std::string &expression);
+
+	/*
+	 * Region chunk query destructor
+	 */
+	virtual ~region_chunk_query(void) { return; }
+
+	/*
+	 * Returns the query expression
+	 */
+	std::string get_expression(void) { return expression; }
+
+	/*
+	 * Collects the tags matching the query in a chunk tag
+	 * (full or query-read trees, see region_file::get_chunk_tag)
+	 */
+	void run(region_chunk_tag &tag, std::vector<generic_tag *> &results) const;
+
+	/*
+	 * Sets & compiles the query expression
+	 */
+	void set_expression(const std::string &expression);
+
+	/*
+	 * Returns the number of compiled steps
+	 */
+	unsigned int size(void) const { return steps.size(); }
+
+	/*
+	 * Returns a string representation of a region chunk query
+	 */
+	std::string to_string(void);
+};
+
+#endif
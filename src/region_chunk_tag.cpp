@@ -52,8 +52,7 @@ region_chunk_tag &region_chunk_tag::operator=(const region_chunk_tag &other) {
 		return *this;
 
 	// set attributes
-	if(root)
-		cleanup(root);
+	cleanup();
 	if(!copy(other.root, root))
 		root = NULL;
 	return *this;
@@ -78,6 +77,15 @@ bool region_chunk_tag::operator==(const region_chunk_tag &other) {
 	return equals(root, other.root);
 }
 
+/*
+ * Cleanup a root tag
+ */
+void region_chunk_tag::cleanup(void) {
+	cleanup(root);
+	root = NULL;
+	arena.release();
+}
+
 /*
  * Cleanup a series of tags
  */
@@ -85,8 +93,9 @@ void region_chunk_tag::cleanup(generic_tag *&tag) {
 	compound_tag *cmp_tag = NULL;
 	list_tag *lst_tag = NULL;
 
-	// check for valid tag
-	if(!tag)
+	// check for valid (heap allocated) tag
+	if(!tag
+			|| tag->is_pooled())
 		return;
 
 	// cleanup each tag based off its type
@@ -148,12 +157,16 @@ bool region_chunk_tag::copy(generic_tag *src, generic_tag *&dest) {
 				value.push_back(new_tag);
 			}
 			dest = new list_tag(src->get_name(), value);
+			static_cast<list_tag *>(dest)->set_element_type(lst_tag->get_element_type());
 			break;
 		default:
 			switch(src->get_type()) {
 				case generic_tag::BYTE_ARRAY:
 					dest = new byte_array_tag(*static_cast<byte_array_tag *>(src));
 					break;
+				case generic_tag::INT_ARRAY:
+					dest = new int_array_tag(*static_cast<int_array_tag *>(src));
+					break;
 				case generic_tag::BYTE:
 					dest = new byte_tag(*static_cast<byte_tag *>(src));
 					break;
@@ -217,6 +230,10 @@ bool region_chunk_tag::equals(generic_tag *tag1, generic_tag *tag2) {
 			if(*static_cast<byte_array_tag *>(tag1) != *static_cast<byte_array_tag *>(tag2))
 				return false;
 			break;
+		case generic_tag::INT_ARRAY:
+			if(*static_cast<int_array_tag *>(tag1) != *static_cast<int_array_tag *>(tag2))
+				return false;
+			break;
 		case generic_tag::BYTE:
 			if(*static_cast<byte_tag *>(tag1) != *static_cast<byte_tag *>(tag2))
 				return false;
@@ -256,10 +273,50 @@ bool region_chunk_tag::equals(generic_tag *tag1, generic_tag *tag2) {
 	return true;
 }
 
+/*
+ * Return a region chunk tag tag at a given name
+ */
+generic_tag *region_chunk_tag::get_tag_by_name(const std::string &name) {
+	uint32_t id = tag_name_pool::find(name);
+
+	// names never pooled match no tag
+	if(id == tag_name_pool::NONE)
+		return NULL;
+	return get_tag_by_name_helper(id, root);
+}
+
+/*
+ * Return a region chunk tag tag at a given path
+ */
+generic_tag *region_chunk_tag::get_tag_by_path(const std::string &path) {
+	std::vector<uint32_t> ids;
+
+	parse_path(path, ids);
+	return get_tag_by_path(ids);
+}
+
+/*
+ * Return a region chunk tag tag at a given path
+ */
+generic_tag *region_chunk_tag::get_tag_by_path(const std::vector<uint32_t> &path) {
+	generic_tag *tag = root;
+
+	// descend through compounds by name (indexed, no tree walk)
+	for(unsigned int i = 0; i < path.size(); ++i) {
+		if(!tag
+				|| path[i] == tag_name_pool::NONE
+				|| tag->get_type() != generic_tag::COMPOUND)
+			return NULL;
+		tag = static_cast<compound_tag *>(tag)->find(path[i]);
+	}
+	return tag;
+}
+
 /*
  * Get tag by name helper
+ * (names are compared by pooled id)
  */
-generic_tag *region_chunk_tag::get_tag_by_name_helper(const std::string &name, generic_tag *root) {
+generic_tag *region_chunk_tag::get_tag_by_name_helper(uint32_t name, generic_tag *root) {
 	compound_tag *cmp_tag = NULL;
 	list_tag *lst_tag = NULL;
 
@@ -268,7 +325,7 @@ generic_tag *region_chunk_tag::get_tag_by_name_helper(const std::string &name, g
 		return NULL;
 
 	// check tag for matching name
-	if(root->get_name() == name)
+	if(root->has_name(name))
 		return root;
 
 	// iterate through all complex types
@@ -290,6 +347,103 @@ generic_tag *region_chunk_tag::get_tag_by_name_helper(const std::string &name, g
 	return NULL;
 }
 
+/*
+ * Converts a dot separated path into pooled name ids
+ */
+void region_chunk_tag::parse_path(const std::string &path, std::vector<uint32_t> &ids) {
+	size_t pos = 0, next;
+
+	// names are looked up, not pooled (unpooled names are NONE, which no tag has)
+	ids.clear();
+	do {
+		next = path.find('.', pos);
+		ids.push_back(tag_name_pool::find(path.substr(pos, (next == std::string::npos ? path.size() : next) - pos)));
+		pos = next + 1;
+	} while(next != std::string::npos);
+}
+
+/*
+ * Serializes a named tag (type, name & value) into a stream
+ */
+bool region_chunk_tag::write(generic_tag *tag, byte_stream_writer &stream) {
+
+	// check for valid tag
+	if(!tag)
+		return false;
+
+	// end tags carry no name or value
+	if(!(stream << (int8_t) tag->get_type()))
+		return false;
+	if(tag->get_type() == generic_tag::END)
+		return true;
+	if(!(stream << tag->get_name()))
+		return false;
+	return write_value(tag, stream);
+}
+
+/*
+ * Serializes a tags value into a stream
+ */
+bool region_chunk_tag::write_value(generic_tag *tag, byte_stream_writer &stream) {
+	byte_array_tag *arr_tag = NULL;
+	int_array_tag *int_arr_tag = NULL;
+	compound_tag *cmp_tag = NULL;
+	list_tag *lst_tag = NULL;
+	int8_t ele_type = generic_tag::END;
+
+	// check for valid tag
+	if(!tag)
+		return false;
+
+	// write value based off type
+	switch(tag->get_type()) {
+		case generic_tag::BYTE:
+			return stream << static_cast<byte_tag *>(tag)->value;
+		case generic_tag::BYTE_ARRAY:
+			arr_tag = static_cast<byte_array_tag *>(tag);
+			return (stream << (int32_t) arr_tag->size())
+					&& stream.write(arr_tag->value);
+		case generic_tag::COMPOUND:
+			cmp_tag = static_cast<compound_tag *>(tag);
+			for(unsigned int i = 0; i < cmp_tag->size(); ++i)
+				if(!write(cmp_tag->at(i), stream))
+					return false;
+			return stream << (int8_t) generic_tag::END;
+		case generic_tag::DOUBLE:
+			return stream << static_cast<double_tag *>(tag)->value;
+		case generic_tag::END:
+			break;
+		case generic_tag::FLOAT:
+			return stream << static_cast<float_tag *>(tag)->value;
+		case generic_tag::INT:
+			return stream << static_cast<int_tag *>(tag)->value;
+		case generic_tag::INT_ARRAY:
+			int_arr_tag = static_cast<int_array_tag *>(tag);
+			return (stream << (int32_t) int_arr_tag->size())
+					&& stream.write(int_arr_tag->value);
+		case generic_tag::LIST:
+			lst_tag = static_cast<list_tag *>(tag);
+			ele_type = lst_tag->get_element_type();
+			if(!(stream << ele_type)
+					|| !(stream << (int32_t) lst_tag->size()))
+				return false;
+			for(unsigned int i = 0; i < lst_tag->size(); ++i)
+				if(!write_value(lst_tag->at(i), stream))
+					return false;
+			break;
+		case generic_tag::LONG:
+			return stream << static_cast<long_tag *>(tag)->value;
+		case generic_tag::SHORT:
+			return stream << static_cast<short_tag *>(tag)->value;
+		case generic_tag::STRING:
+			return stream << static_cast<string_tag *>(tag)->value;
+		default:
+			throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, tag->get_type());
+			break;
+	}
+	return true;
+}
+
 /*
  * Returns a string representation of a region chunk tag
  */
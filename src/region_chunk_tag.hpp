@@ -20,6 +20,7 @@
 #ifndef REGION_CHUNK_TAG_HPP_
 #define REGION_CHUNK_TAG_HPP_
 
+#include "byte_stream_writer.hpp"
 #include "tag/byte_array_tag.hpp"
 #include "tag/byte_tag.hpp"
 #include "tag/compound_tag.hpp"
@@ -27,6 +28,7 @@
 #include "tag/end_tag.hpp"
 #include "tag/float_tag.hpp"
 #include "tag/generic_tag.hpp"
+#include "tag/int_array_tag.hpp"
 #include "tag/int_tag.hpp"
 #include "tag/list_tag.hpp"
 #include "tag/long_tag.hpp"
@@ -41,10 +43,16 @@ private:
 	 */
 	generic_tag *root;
 
+	/*
+	 * Tag arena
+	 * (parsed trees are allocated here and freed in a single release)
+	 */
+	tag_arena arena;
+
 	/*
 	 * Get tag by name helper
 	 */
-	generic_tag *get_tag_by_name_helper(const std::string &name, generic_tag *root);
+	generic_tag *get_tag_by_name_helper(uint32_t name, generic_tag *root);
 
 public:
 
@@ -85,11 +93,13 @@ public:
 
 	/*
 	 * Cleanup a root tag
+	 * (releases the arena holding a parsed tree)
 	 */
-	void cleanup(void) { cleanup(root); }
+	void cleanup(void);
 
 	/*
 	 * Cleanup a series of tags
+	 * (pooled tags are left to their arena)
 	 */
 	static void cleanup(generic_tag *&tag);
 
@@ -113,6 +123,11 @@ public:
 	 */
 	static bool equals(generic_tag *tag1, generic_tag *tag2);
 
+	/*
+	 * Returns the region chunk tags arena
+	 */
+	tag_arena &get_arena(void) { return arena; }
+
 	/*
 	 * Return region chunk tag root tag
 	 */
@@ -121,7 +136,41 @@ public:
 	/*
 	 * Return a region chunk tag tag at a given name
 	 */
-	generic_tag *get_tag_by_name(const std::string &name) { return get_tag_by_name_helper(name, root); }
+	generic_tag *get_tag_by_name(const std::string &name);
+
+	/*
+	 * Return a region chunk tag tag at a given path
+	 * (dot separated compound names below the root, e.g. Level.Blocks)
+	 */
+	generic_tag *get_tag_by_path(const std::string &path);
+
+	/*
+	 * Return a region chunk tag tag at a given path
+	 * (pooled name ids, see parse_path)
+	 */
+	generic_tag *get_tag_by_path(const std::vector<uint32_t> &path);
+
+	/*
+	 * Converts a dot separated path into pooled name ids
+	 * (resolve a path once to look it up in many chunks, names not yet
+	 * pooled are NONE and match nothing)
+	 */
+	static void parse_path(const std::string &path, std::vector<uint32_t> &ids);
+
+	/*
+	 * Serializes the root tag into a stream
+	 */
+	bool write(byte_stream_writer &stream) { return write(root, stream); }
+
+	/*
+	 * Serializes a named tag (type, name & value) into a stream
+	 */
+	static bool write(generic_tag *tag, byte_stream_writer &stream);
+
+	/*
+	 * Serializes a tags value into a stream
+	 */
+	static bool write_value(generic_tag *tag, byte_stream_writer &stream);
 
 	/*
 	 * Returns a string representation of a region chunk tag
@@ -0,0 +1,365 @@
+/*
+ * region_chunk_tape.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "byte_order.hpp"
+#include "region_chunk_tape.hpp"
+#include "region_file_exc.hpp"
+#include "tag/generic_tag.hpp"
+
+/*
+ * Returns a child at a given index in a compound/list
+ */
+region_chunk_tape::cursor region_chunk_tape::cursor::at(unsigned int index) const {
+	cursor child = first();
+
+	// fixed width elements take one entry each
+	if(child.valid()
+			&& get_type() == generic_tag::LIST
+			&& generic_tag::type_width(get_element_type())) {
+		if(index >= size())
+			return cursor();
+		return cursor(tape, child.index + index, child.end);
+	}
+	for(; index && child.valid(); --index)
+		child = child.next();
+	return child;
+}
+
+/*
+ * Returns a compounds first child with a given name
+ */
+region_chunk_tape::cursor region_chunk_tape::cursor::find(const std::string &name) const {
+	cursor child;
+
+	// check for a compound
+	if(!valid()
+			|| get_type() != generic_tag::COMPOUND)
+		return cursor();
+	for(child = first(); child.valid(); child = child.next())
+		if(child.has_name(name))
+			return child;
+	return cursor();
+}
+
+/*
+ * Returns the first child of a compound/list
+ */
+region_chunk_tape::cursor region_chunk_tape::cursor::first(void) const {
+
+	// check for children
+	if(!valid())
+		return cursor();
+	const entry &ent = get_entry();
+	if((ent.type != generic_tag::COMPOUND
+			&& ent.type != generic_tag::LIST)
+			|| !ent.value.range[0])
+		return cursor();
+	return cursor(tape, index + 1, ent.value.range[1]);
+}
+
+/*
+ * Returns a byte arrays bytes
+ */
+const int8_t *region_chunk_tape::cursor::get_bytes(void) const {
+	const entry &ent = get_entry();
+
+	if(ent.type != generic_tag::BYTE_ARRAY)
+		throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, (int) ent.type);
+	return tape->data.data() + ent.value.range[0];
+}
+
+/*
+ * Returns an int arrays values
+ */
+void region_chunk_tape::cursor::get_ints(std::vector<int32_t> &value) const {
+	const entry &ent = get_entry();
+
+	if(ent.type != generic_tag::INT_ARRAY)
+		throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, (int) ent.type);
+
+	// values are kept big-endian in data (swapped on access)
+	value.resize(ent.value.range[1]);
+	if(!value.empty())
+		byte_order::load_array<int32_t>(value.data(), tape->data.data() + ent.value.range[0], value.size(), false);
+}
+
+/*
+ * Returns the cursors entry
+ */
+const region_chunk_tape::entry &region_chunk_tape::cursor::get_entry(void) const {
+
+	// check for a valid cursor (e.g. a failed find)
+	if(!valid())
+		throw region_file_exc(region_file_exc::TAG_NOT_FOUND);
+	return tape->entries[index];
+}
+
+/*
+ * Returns a byte/short/int/long value
+ */
+int64_t region_chunk_tape::cursor::get_integer(void) const {
+	const entry &ent = get_entry();
+
+	switch(ent.type) {
+		case generic_tag::BYTE:
+		case generic_tag::SHORT:
+		case generic_tag::INT:
+		case generic_tag::LONG:
+			return ent.value.integer;
+		default: throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, (int) ent.type);
+	}
+}
+
+/*
+ * Returns a tag name
+ */
+std::string region_chunk_tape::cursor::get_name(void) const {
+	const entry &ent = get_entry();
+	const char *name = reinterpret_cast<const char *>(tape->data.data() + ent.name);
+
+	return std::string(name, ent.name_len);
+}
+
+/*
+ * Returns a float/double value
+ */
+double region_chunk_tape::cursor::get_real(void) const {
+	const entry &ent = get_entry();
+
+	switch(ent.type) {
+		case generic_tag::FLOAT:
+		case generic_tag::DOUBLE:
+			return ent.value.real;
+		default: throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, (int) ent.type);
+	}
+}
+
+/*
+ * Returns a string value
+ */
+std::string region_chunk_tape::cursor::get_string(void) const {
+	const entry &ent = get_entry();
+
+	if(ent.type != generic_tag::STRING)
+		throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, (int) ent.type);
+	return std::string(reinterpret_cast<const char *>(tape->data.data() + ent.value.range[0]), ent.value.range[1]);
+}
+
+/*
+ * Returns true if a tag has a given name
+ */
+bool region_chunk_tape::cursor::has_name(const std::string &name) const {
+	const entry &ent = get_entry();
+
+	return ent.name_len == name.size()
+			&& !memcmp(tape->data.data() + ent.name, name.data(), name.size());
+}
+
+/*
+ * Returns the next sibling
+ */
+region_chunk_tape::cursor region_chunk_tape::cursor::next(void) const {
+
+	// check for a sibling
+	if(!valid())
+		return cursor();
+	const entry &ent = get_entry();
+
+	// compounds & lists are followed by their descendants
+	if(ent.type == generic_tag::COMPOUND
+			|| ent.type == generic_tag::LIST)
+		return cursor(tape, ent.value.range[1], end);
+	return cursor(tape, index + 1, end);
+}
+
+/*
+ * Returns the child count of a compound/list, or the length of a string/array
+ */
+unsigned int region_chunk_tape::cursor::size(void) const {
+	const entry &ent = get_entry();
+
+	switch(ent.type) {
+		case generic_tag::COMPOUND:
+		case generic_tag::LIST:
+			return ent.value.range[0];
+		case generic_tag::BYTE_ARRAY:
+		case generic_tag::INT_ARRAY:
+		case generic_tag::STRING:
+			return ent.value.range[1];
+		default: return 0;
+	}
+}
+
+/*
+ * Discards the tapes contents
+ */
+void region_chunk_tape::clear(void) {
+	entries.clear();
+	data.clear();
+}
+
+/*
+ * Builds the tape from data in a single pass
+ */
+void region_chunk_tape::parse(void) {
+	int8_t type;
+	int16_t name_len;
+
+	// setup stream as a view over data (no copy)
+	entries.clear();
+	byte_stream stream(data.data(), data.size());
+	stream << byte_stream::NO_SWAP_ENDIAN;
+
+	// parse root tag
+	if(!(stream >> type))
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+	if(type == generic_tag::END) {
+		read_tag(type, 0, 0, stream);
+		return;
+	}
+	if(!(stream >> name_len)
+			|| name_len < 0
+			|| !stream.skip(name_len))
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+
+	// most tags take several bytes of data
+	entries.reserve(data.size() / 8);
+	read_tag(type, stream.position() - name_len, name_len, stream);
+}
+
+/*
+ * Builds the tape from uncompressed chunk data
+ */
+void region_chunk_tape::read(const int8_t *data, uint64_t len) {
+	this->data.assign(data, data + len);
+	parse();
+}
+
+/*
+ * Appends a tag (and its descendants) to the tape
+ */
+void region_chunk_tape::read_tag(int8_t type, uint32_t name, uint16_t name_len, byte_stream &stream) {
+	bool result = true;
+	int8_t b_val, ele_type;
+	int16_t s_val, ele_name_len;
+	int32_t i_val, len;
+	int64_t l_val;
+	float f_val;
+	double d_val;
+	uint32_t count = 0;
+	uint64_t index = entries.size();
+	entry ent;
+
+	// append entry (children follow)
+	ent.name = name;
+	ent.name_len = name_len;
+	ent.type = type;
+	ent.element = generic_tag::END;
+	ent.value.integer = 0;
+	entries.push_back(ent);
+
+	// assign value based off type
+	switch(type) {
+		case generic_tag::BYTE:
+			if((result = stream >> b_val))
+				entries[index].value.integer = b_val;
+			break;
+		case generic_tag::BYTE_ARRAY:
+		case generic_tag::INT_ARRAY:
+			if(!(result = (stream >> len) && len >= 0))
+				break;
+			entries[index].value.range[0] = stream.position();
+			entries[index].value.range[1] = len;
+			result = stream.skip((uint64_t) len * (type == generic_tag::BYTE_ARRAY ? sizeof(int8_t) : sizeof(int32_t)));
+			break;
+		case generic_tag::COMPOUND:
+			while((result = stream >> ele_type)
+					&& ele_type != generic_tag::END) {
+				if(!(result = (stream >> ele_name_len) && ele_name_len >= 0 && stream.skip(ele_name_len)))
+					break;
+				read_tag(ele_type, stream.position() - ele_name_len, ele_name_len, stream);
+				++count;
+			}
+			entries[index].value.range[0] = count;
+			entries[index].value.range[1] = entries.size();
+			break;
+		case generic_tag::DOUBLE:
+			if((result = stream >> d_val))
+				entries[index].value.real = d_val;
+			break;
+		case generic_tag::END:
+			break;
+		case generic_tag::FLOAT:
+			if((result = stream >> f_val))
+				entries[index].value.real = f_val;
+			break;
+		case generic_tag::INT:
+			if((result = stream >> i_val))
+				entries[index].value.integer = i_val;
+			break;
+		case generic_tag::LIST:
+			if(!(result = (stream >> ele_type) && (stream >> len) && len >= 0))
+				break;
+
+			// every element takes at least a byte (bounds corrupt lengths)
+			if(!(result = ele_type == generic_tag::END ? !len : (uint64_t) len <= stream.available()))
+				break;
+			entries[index].element = ele_type;
+			for(int32_t i = 0; i < len; ++i)
+				read_tag(ele_type, 0, 0, stream);
+			entries[index].value.range[0] = len;
+			entries[index].value.range[1] = entries.size();
+			break;
+		case generic_tag::LONG:
+			if((result = stream >> l_val))
+				entries[index].value.integer = l_val;
+			break;
+		case generic_tag::SHORT:
+			if((result = stream >> s_val))
+				entries[index].value.integer = s_val;
+			break;
+		case generic_tag::STRING:
+			if(!(result = (stream >> s_val) && s_val >= 0))
+				break;
+			entries[index].value.range[0] = stream.position();
+			entries[index].value.range[1] = s_val;
+			result = stream.skip(s_val);
+			break;
+		default:
+			throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, (int) type);
+	}
+
+	// check stream status
+	if(!result)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+}
+
+/*
+ * Returns a string representation of a region chunk tape
+ */
+std::string region_chunk_tape::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[TAPE] entries: " << entries.size() << ", data: " << data.size();
+	return ss.str();
+}
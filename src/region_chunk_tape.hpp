@@ -0,0 +1,243 @@
+/*
+ * region_chunk_tape.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGION_CHUNK_TAPE_HPP_
+#define REGION_CHUNK_TAPE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "byte_stream.hpp"
+
+class region_chunk_tape {
+private:
+
+	/*
+	 * Region files fill the tapes data directly
+	 */
+	friend class region_file;
+
+	/*
+	 * Tape entry
+	 * (one per tag, in document order, children directly follow their parent)
+	 */
+	class entry {
+	public:
+
+		/*
+		 * Name offset/length in data
+		 */
+		uint32_t name;
+		uint16_t name_len;
+
+		/*
+		 * Tag type & list element type
+		 */
+		int8_t type, element;
+
+		/*
+		 * Tag value
+		 * (numbers in place, {offset, length} of strings & arrays in data,
+		 * {child count, index past the last descendant} of compounds & lists)
+		 */
+		union {
+			int64_t integer;
+			double real;
+			uint32_t range[2];
+		} value;
+	};
+
+	/*
+	 * Tape entries
+	 */
+	std::vector<entry> entries;
+
+	/*
+	 * Uncompressed chunk data
+	 * (names, strings & arrays are referenced in place)
+	 */
+	std::vector<int8_t> data;
+
+	/*
+	 * Builds the tape from data in a single pass
+	 */
+	void parse(void);
+
+	/*
+	 * Appends a tag (and its descendants) to the tape
+	 */
+	void read_tag(int8_t type, uint32_t name, uint16_t name_len, byte_stream &stream);
+
+public:
+
+	/*
+	 * Tape cursor
+	 * (a position on the tape, bounded by its parents descendants)
+	 */
+	class cursor {
+	private:
+
+		/*
+		 * Source tape
+		 */
+		const region_chunk_tape *tape;
+
+		/*
+		 * Entry index & sibling bound
+		 */
+		uint32_t index, end;
+
+		/*
+		 * Returns the cursors entry
+		 * (throws TAG_NOT_FOUND for invalid cursors)
+		 */
+		const entry &get_entry(void) const;
+
+	public:
+
+		/*
+		 * Cursor constructor
+		 */
+		cursor(void) : tape(NULL), index(0), end(0) { return; }
+
+		/*
+		 * Cursor constructor
+		 */
+		cursor(const region_chunk_tape *tape, uint32_t index, uint32_t end) : tape(tape), index(index), end(end) { return; }
+
+		/*
+		 * Returns a child at a given index in a compound/list
+		 * (fixed width list elements are found directly)
+		 */
+		cursor at(unsigned int index) const;
+
+		/*
+		 * Returns a compounds first child with a given name
+		 */
+		cursor find(const std::string &name) const;
+
+		/*
+		 * Returns the first child of a compound/list
+		 */
+		cursor first(void) const;
+
+		/*
+		 * Returns a byte arrays bytes (in place, size() bytes)
+		 */
+		const int8_t *get_bytes(void) const;
+
+		/*
+		 * Returns an int arrays values
+		 */
+		void get_ints(std::vector<int32_t> &value) const;
+
+		/*
+		 * Returns a byte/short/int/long value
+		 */
+		int64_t get_integer(void) const;
+
+		/*
+		 * Returns a list element type
+		 */
+		char get_element_type(void) const { return get_entry().element; }
+
+		/*
+		 * Returns a tag name
+		 */
+		std::string get_name(void) const;
+
+		/*
+		 * Returns a float/double value
+		 */
+		double get_real(void) const;
+
+		/*
+		 * Returns a string value
+		 */
+		std::string get_string(void) const;
+
+		/*
+		 * Returns a tag type
+		 */
+		char get_type(void) const { return get_entry().type; }
+
+		/*
+		 * Returns true if a tag has a given name
+		 * (compared in place, no copy is made)
+		 */
+		bool has_name(const std::string &name) const;
+
+		/*
+		 * Returns the next sibling
+		 */
+		cursor next(void) const;
+
+		/*
+		 * Returns the child count of a compound/list, or the length of a string/array
+		 */
+		unsigned int size(void) const;
+
+		/*
+		 * Returns the valid status of a cursor
+		 */
+		bool valid(void) const { return tape && index < end; }
+	};
+
+	/*
+	 * Region chunk tape constructor
+	 */
+	region_chunk_tape(void) { return; }
+
+	/*
+	 * Region chunk tape destructor
+	 */
+	virtual ~region_chunk_tape(void) { return; }
+
+	/*
+	 * Discards the tapes contents (capacity is kept)
+	 */
+	void clear(void);
+
+	/*
+	 * Returns the empty status of the tape
+	 */
+	bool empty(void) { return entries.empty(); }
+
+	/*
+	 * Builds the tape from uncompressed chunk data (data is copied)
+	 */
+	void read(const int8_t *data, uint64_t len);
+
+	/*
+	 * Returns a cursor at the root tag
+	 */
+	cursor root(void) const { return cursor(this, 0, entries.size()); }
+
+	/*
+	 * Returns the number of tape entries
+	 */
+	uint64_t size(void) { return entries.size(); }
+
+	/*
+	 * Returns a string representation of a region chunk tape
+	 */
+	std::string to_string(void);
+};
+
+#endif
@@ -0,0 +1,283 @@
+/*
+ * region_compactor.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "region_compactor.hpp"
+#include "region_file_exc.hpp"
+#include "region_file_writer.hpp"
+
+/*
+ * Chunk order names
+ */
+const std::string region_compactor::NAME[ORDER_COUNT] = {
+		"disk",
+		"z-order",
+		"hottest",
+};
+
+/*
+ * Temporary output directory template
+ */
+const std::string region_compactor::TEMP_DIR = ".compact.XXXXXX";
+
+/*
+ * Region compactor constructor
+ */
+region_compactor::region_compactor(const std::string &path) : path(path), heat(region_file::CHUNK_COUNT, 0), chunks(0),
+		size_before(0), size_after(0), free_before(0), free_after(0), holes_before(0), holes_after(0) {
+	return;
+}
+
+/*
+ * Compacts the region file in place
+ */
+void region_compactor::compact(unsigned int order) {
+	compact_staged(path, order);
+}
+
+/*
+ * Compacts the region file into output
+ */
+void region_compactor::compact(const std::string &output, unsigned int order) {
+	compact_staged(output, order);
+}
+
+/*
+ * Compacts the region file into a temporary file, then renames it over output
+ */
+void region_compactor::compact_staged(const std::string &output, unsigned int order) {
+	std::string dir, staged;
+	size_t sep = output.find_last_of('/');
+
+	// check for a supported order
+	if(order >= ORDER_COUNT)
+		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, order);
+
+	// stage output beside its destination (same file name, so it still parses as a region file)
+	dir = (sep == std::string::npos ? std::string() : output.substr(0, sep + 1)) + TEMP_DIR;
+	std::vector<char> dir_buff(dir.begin(), dir.end());
+	dir_buff.push_back('\0');
+	if(!mkdtemp(dir_buff.data()))
+		throw region_file_exc(region_file_exc::INVALID_PATH, dir);
+	dir = dir_buff.data();
+	staged = dir + "/" + output.substr(sep == std::string::npos ? 0 : sep + 1);
+
+	// replace output only once the copy is verified (the original is never
+	// removed, even if output names the same file)
+	try {
+		compact_to(staged, order);
+		if(rename(staged.c_str(), output.c_str()))
+			throw region_file_exc(region_file_exc::STREAM_WRITE_ERROR, staged);
+	} catch(...) {
+		unlink(staged.c_str());
+		rmdir(dir.c_str());
+		throw;
+	}
+	rmdir(dir.c_str());
+}
+
+/*
+ * Compacts the region file into a new file at output
+ */
+void region_compactor::compact_to(const std::string &output, unsigned int order) {
+	uint64_t len;
+	const int8_t *data = NULL;
+	std::vector<unsigned int> index;
+	region_chunk_info info;
+
+	// open the original before anything is written
+	scan(path, size_before, free_before, holes_before);
+	region_file region(path);
+	order_chunks(region, order, index);
+
+	// copy payloads back to back (a fresh writer appends in order)
+	{
+		region_file_writer writer(output);
+		for(unsigned int i = 0; i < index.size(); ++i) {
+			unsigned int x = index.at(i) % region_file::REGION_SIZE, z = index.at(i) / region_file::REGION_SIZE;
+			info = region.read_chunk_data(x, z, data, len);
+			writer.write_chunk_payload(x, z, info.get_type(), data, len, info.get_modified());
+		}
+		writer.flush();
+	}
+	chunks = index.size();
+
+	// check result before reporting
+	verify(region, output);
+	scan(output, size_after, free_after, holes_after);
+}
+
+/*
+ * Returns the fragmentation after the last compaction
+ */
+double region_compactor::get_fragmentation_after(void) {
+	uint64_t sectors = size_after / region_file::SECTOR_SIZE;
+	return sectors ? (double) free_after / sectors : 0.0;
+}
+
+/*
+ * Returns the fragmentation before the last compaction
+ */
+double region_compactor::get_fragmentation_before(void) {
+	uint64_t sectors = size_before / region_file::SECTOR_SIZE;
+	return sectors ? (double) free_before / sectors : 0.0;
+}
+
+/*
+ * Returns chunk indices in a given order
+ */
+void region_compactor::order_chunks(region_file &region, unsigned int order, std::vector<unsigned int> &index) {
+	std::pair<uint64_t, uint64_t> key;
+	std::vector<std::pair<std::pair<uint64_t, uint64_t>, unsigned int> > keys;
+
+	for(unsigned int i = 0; i < region_file::CHUNK_COUNT; ++i) {
+		region_chunk_info &info = region.info[i];
+		if(!info.get_position())
+			continue;
+
+		// form sort key for order
+		key = std::make_pair(0, 0);
+		switch(order) {
+			case Z_ORDER:
+
+				// interleave x, z coord bits (morton code)
+				for(unsigned int bit = 0; bit < 5; ++bit)
+					key.first |= (((i % region_file::REGION_SIZE) >> bit) & 1) << (2 * bit)
+							| (((i / region_file::REGION_SIZE) >> bit) & 1) << (2 * bit + 1);
+				break;
+			case HOTTEST:
+
+				// hottest, then most recently modified, first
+				key.first = ~heat.at(i);
+				key.second = ~(uint64_t) (uint32_t) info.get_modified();
+				break;
+			default: key.first = info.get_position();
+				break;
+		}
+		keys.push_back(std::make_pair(key, i));
+	}
+	std::sort(keys.begin(), keys.end());
+	index.clear();
+	for(unsigned int i = 0; i < keys.size(); ++i)
+		index.push_back(keys.at(i).second);
+}
+
+/*
+ * Measures a region files size & free sector layout
+ */
+void region_compactor::scan(const std::string &path, uint64_t &size, unsigned int &free, unsigned int &holes) {
+	struct stat st;
+	std::vector<bool> used;
+	region_file region(path);
+
+	// mark sectors used by the header & each chunk
+	if(stat(path.c_str(), &st))
+		throw region_file_exc(region_file_exc::INVALID_PATH, path);
+	size = st.st_size;
+	used.assign((size + region_file::SECTOR_SIZE - 1) / region_file::SECTOR_SIZE, false);
+	for(unsigned int i = 0; i < region_file::HEADER_SIZE / region_file::SECTOR_SIZE && i < used.size(); ++i)
+		used[i] = true;
+	for(unsigned int i = 0; i < region_file::CHUNK_COUNT; ++i) {
+		region_chunk_info &info = region.info[i];
+		if(!info.get_position())
+			continue;
+		for(unsigned int j = 0; j < info.get_sectors(); ++j) {
+			uint64_t sector = info.get_position() / region_file::SECTOR_SIZE + j;
+			if(sector < used.size())
+				used[sector] = true;
+		}
+	}
+
+	// count free sectors & runs of them
+	free = 0;
+	holes = 0;
+	for(unsigned int i = 0; i < used.size(); ++i)
+		if(!used[i]) {
+			++free;
+			if(!i
+					|| used[i - 1])
+				++holes;
+		}
+}
+
+/*
+ * Sets a chunks heat at a given x, z coord
+ */
+void region_compactor::set_heat(unsigned int x, unsigned int z, uint64_t heat) {
+
+	// check if x, z coord are out-of-bounds
+	if(x + z * region_file::REGION_SIZE >= region_file::CHUNK_COUNT) {
+		unsigned int coord[] = {x, z};
+		std::vector<unsigned int> coord_vec(coord, coord + 2);
+		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, coord_vec);
+	}
+	this->heat.at(x + z * region_file::REGION_SIZE) = heat;
+}
+
+/*
+ * Returns a string representation of a region compactor report
+ */
+std::string region_compactor::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[COMPACTOR] " << path << ", chunks: " << chunks
+			<< ", size: " << size_before << " -> " << size_after << " (reclaimed: " << get_reclaimed() << ")"
+			<< ", free sectors: " << free_before << " -> " << free_after
+			<< ", holes: " << holes_before << " -> " << holes_after
+			<< ", fragmentation: " << get_fragmentation_before() * 100.0 << "% -> " << get_fragmentation_after() * 100.0 << "%";
+	return ss.str();
+}
+
+/*
+ * Checks that every chunk in output matches its source
+ */
+void region_compactor::verify(region_file &source, const std::string &output) {
+	uint64_t len, out_len;
+	const int8_t *data = NULL, *out_data = NULL;
+	std::vector<int8_t> copy;
+	region_file result(output);
+
+	for(unsigned int i = 0; i < region_file::CHUNK_COUNT; ++i) {
+		unsigned int x = i % region_file::REGION_SIZE, z = i / region_file::REGION_SIZE;
+
+		// check fill status
+		if(source.is_filled(x, z) != result.is_filled(x, z))
+			throw region_file_exc(region_file_exc::UNFILLED_CHUNK, output);
+		if(!source.is_filled(x, z))
+			continue;
+
+		// check payload, compression type & timestamp
+		region_chunk_info info = source.read_chunk_data(x, z, data, len);
+		copy.assign(data, data + len);
+		region_chunk_info out_info = result.read_chunk_data(x, z, out_data, out_len);
+		if(info.get_type() != out_info.get_type()
+				|| info.get_modified() != out_info.get_modified()
+				|| len != out_len
+				|| (len && memcmp(copy.data(), out_data, len)))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, output);
+	}
+}
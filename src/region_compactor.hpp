@@ -0,0 +1,165 @@
+/*
+ * region_compactor.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGION_COMPACTOR_HPP_
+#define REGION_COMPACTOR_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "region_file.hpp"
+
+class region_compactor {
+private:
+
+	/*
+	 * Region file path
+	 */
+	std::string path;
+
+	/*
+	 * Chunk heat (access counts for hottest-first ordering)
+	 */
+	std::vector<uint64_t> heat;
+
+	/*
+	 * Chunks moved
+	 */
+	unsigned int chunks;
+
+	/*
+	 * Region file size before/after compaction
+	 */
+	uint64_t size_before, size_after;
+
+	/*
+	 * Free sectors & holes (free sector runs) before/after compaction
+	 */
+	unsigned int free_before, free_after, holes_before, holes_after;
+
+	/*
+	 * Returns chunk indices in a given order
+	 */
+	void order_chunks(region_file &region, unsigned int order, std::vector<unsigned int> &index);
+
+	/*
+	 * Compacts the region file into a temporary file, then renames it over output
+	 * (output is only replaced once the copy is verified)
+	 */
+	void compact_staged(const std::string &output, unsigned int order);
+
+	/*
+	 * Compacts the region file into a new file at output
+	 */
+	void compact_to(const std::string &output, unsigned int order);
+
+	/*
+	 * Measures a region files size & free sector layout
+	 */
+	static void scan(const std::string &path, uint64_t &size, unsigned int &free, unsigned int &holes);
+
+	/*
+	 * Checks that every chunk in output matches its source
+	 * (same payload bytes, compression type & timestamp)
+	 */
+	static void verify(region_file &source, const std::string &output);
+
+public:
+
+	/*
+	 * Chunk orders
+	 */
+	enum ORDER { DISK, Z_ORDER, HOTTEST, };
+	static const std::string NAME[];
+	static const unsigned int ORDER_COUNT = 3;
+
+	/*
+	 * Temporary output directory template (created beside the output)
+	 */
+	static const std::string TEMP_DIR;
+
+	/*
+	 * Region compactor constructor
+	 */
+	region_compactor(const std::string &path);
+
+	/*
+	 * Region compactor destructor
+	 */
+	virtual ~region_compactor(void) { return; }
+
+	/*
+	 * Compacts the region file in place
+	 * (written to a temporary file, verified, then renamed over the original)
+	 */
+	void compact(unsigned int order = DISK);
+
+	/*
+	 * Compacts the region file into output
+	 * (output must be named like a region file, e.g. r.0.0.mcr, and is
+	 * replaced the same way, so it may also be the original)
+	 */
+	void compact(const std::string &output, unsigned int order = DISK);
+
+	/*
+	 * Returns the number of chunks moved by the last compaction
+	 */
+	unsigned int get_chunks(void) { return chunks; }
+
+	/*
+	 * Returns the fragmentation (free sectors per sector) before/after the last compaction
+	 */
+	double get_fragmentation_after(void);
+	double get_fragmentation_before(void);
+
+	/*
+	 * Returns the number of holes (free sector runs) before/after the last compaction
+	 */
+	unsigned int get_holes_after(void) { return holes_after; }
+	unsigned int get_holes_before(void) { return holes_before; }
+
+	/*
+	 * Returns region file path
+	 */
+	std::string get_path(void) { return path; }
+
+	/*
+	 * Returns the bytes reclaimed by the last compaction
+	 */
+	int64_t get_reclaimed(void) { return size_before - size_after; }
+
+	/*
+	 * Returns the region file size before/after the last compaction
+	 */
+	uint64_t get_size_after(void) { return size_after; }
+	uint64_t get_size_before(void) { return size_before; }
+
+	/*
+	 * Sets a chunks heat at a given x, z coord (used by HOTTEST)
+	 * (chunks of equal heat are ordered most recently modified first)
+	 */
+	void set_heat(unsigned int x, unsigned int z, uint64_t heat);
+
+	/*
+	 * Returns a string representation of a region compactor report
+	 */
+	std::string to_string(void);
+};
+
+#endif
@@ -17,19 +17,25 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
 #include <sstream>
-#include <zlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "region_file.hpp"
+#include "region_section_decoder.hpp"
 
 /*
  * Region file pattern
  */
-const boost::regex region_file::PATTERN = boost::regex("r\\.([-]?[0-9]+)\\.([-]?[0-9]+)\\.mcr");
+const boost::regex region_file::PATTERN = boost::regex("r\\.([-]?[0-9]+)\\.([-]?[0-9]+)\\.(mcr|mca)");
 
 /*
  * Region file constructor
  */
-region_file::region_file(void) : filled(0), x(0), z(0) {
+region_file::region_file(void) : arena(NULL), query(NULL), fd(-1), map(NULL), map_len(0), access(READ), format(MCREGION), inflater(&inflate_backend::shared()), filled(0), streaming(false), x(0), z(0) {
 	info = new region_chunk_info[CHUNK_COUNT];
 	if(!info)
 		throw region_file_exc(region_file_exc::ALLOC_FAIL);
@@ -38,7 +44,7 @@ region_file::region_file(void) : filled(0), x(0), z(0) {
 /*
  * Region file constructor
  */
-region_file::region_file(const region_file &other) : filled(other.filled), path(other.path), x(other.x), z(other.z) {
+region_file::region_file(const region_file &other) : arena(NULL), query(NULL), fd(-1), map(NULL), map_len(0), access(other.access), format(other.format), inflater(other.inflater), filled(other.filled), streaming(other.streaming), path(other.path), x(other.x), z(other.z) {
 	info = new region_chunk_info[CHUNK_COUNT];
 	if(!info)
 		throw region_file_exc(region_file_exc::ALLOC_FAIL);
@@ -46,12 +52,18 @@ region_file::region_file(const region_file &other) : filled(other.filled), path(
 	// assign all attributes
 	for(unsigned int i = 0; i < CHUNK_COUNT; ++i)
 		info[i] = other.info[i];
+
+	// copies hold their own descriptor/mapping
+	if(other.fd >= 0)
+		fd = dup(other.fd);
+	if(other.map)
+		map_file(path);
 }
 
 /*
  * Region file constructor
  */
-region_file::region_file(const std::string &path) : filled(0), path(path), x(0), z(0) {
+region_file::region_file(const std::string &path, unsigned int access) : arena(NULL), query(NULL), fd(-1), map(NULL), map_len(0), access(access), format(MCREGION), inflater(&inflate_backend::shared()), filled(0), streaming(false), path(path), x(0), z(0) {
 	info = new region_chunk_info[CHUNK_COUNT];
 	if(!info)
 		throw region_file_exc(region_file_exc::ALLOC_FAIL);
@@ -66,6 +78,8 @@ region_file::region_file(const std::string &path) : filled(0), path(path), x(0),
 		stream.clear();
 		stream << ref[2];
 		stream >> x;
+		if(ref[3] == "mca")
+			format = ANVIL;
 	} else
 		throw region_file_exc(region_file_exc::INVALID_PATH, path);
 
@@ -73,6 +87,15 @@ region_file::region_file(const std::string &path) : filled(0), path(path), x(0),
 	read();
 }
 
+/*
+ * Region file destructor
+ */
+region_file::~region_file(void) {
+	close_file();
+	unmap_file();
+	delete[] info;
+}
+
 /*
  * Region file assignment
  */
@@ -83,8 +106,13 @@ region_file &region_file::operator=(const region_file &other) {
 		return *this;
 
 	// assign attributes
-	file.close();
+	close_file();
+	unmap_file();
+	access = other.access;
+	format = other.format;
+	inflater = other.inflater;
 	filled = other.filled;
+	streaming = other.streaming;
 	path = other.path;
 	x = other.x;
 	z = other.z;
@@ -94,6 +122,10 @@ region_file &region_file::operator=(const region_file &other) {
 		throw region_file_exc(region_file_exc::ALLOC_FAIL);
 	for(unsigned int i = 0; i < CHUNK_COUNT; ++i)
 		info[i] = other.info[i];
+	if(other.fd >= 0)
+		fd = dup(other.fd);
+	if(other.map)
+		map_file(path);
 	return *this;
 }
 
@@ -118,29 +150,22 @@ bool region_file::operator==(const region_file &other) {
 	return true;
 }
 
+/*
+ * Closes the region files descriptor
+ */
+void region_file::close_file(void) {
+	if(fd >= 0)
+		::close(fd);
+	fd = -1;
+}
+
 /*
  * Returnd region chunk data at a given x, z coord
  */
 void region_file::get_chunk_data(unsigned int x, unsigned int z, std::vector<int8_t> &data) {
-	unsigned int pos = x + z * REGION_SIZE;
-
-	// check if x, z coord are out-of-bounds
-	if(pos >= CHUNK_COUNT) {
-		unsigned int coord[] = {x, z};
-		std::vector<unsigned int> coord_vec(coord, coord + 2);
-		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, coord_vec);
-	}
-
-	// check if x, z coord is filled
-	if(!region_chunk_info(this->info[pos]).get_position()) {
-		unsigned int coord[] = {x, z};
-		std::vector<unsigned int> coord_vec(coord, coord + 2);
-		throw region_file_exc(region_file_exc::UNFILLED_CHUNK, coord_vec);
-	}
-
-	// gather chunk info
-	region_chunk_info chunk_info = info[x + z * REGION_SIZE];
-	int comp_size = chunk_info.get_size();
+	uint64_t comp_len;
+	const int8_t *comp = NULL;
+	region_chunk_info chunk_info = read_chunk_data(x, z, comp, comp_len);
 
 	// check if chunk is empty
 	if(chunk_info.get_position() == 0) {
@@ -148,35 +173,50 @@ void region_file::get_chunk_data(unsigned int x, unsigned int z, std::vector<int
 		return;
 	}
 
-	// open region file
-	std::ifstream chunk_file;
-	chunk_file.open(path.c_str(), std::ios::in | std::ios::binary);
-
-	// check if file exists
-	if(!chunk_file)
-		throw region_file_exc(region_file_exc::INVALID_PATH, path);
+	// decompress data
+	switch(chunk_info.get_type()) {
+		case region_chunk_info::GZIP:
+		case region_chunk_info::ZLIB:
+			inflater->inflate(chunk_info.get_type(), comp, comp_len, data);
+			break;
+		case region_chunk_info::UNCOMPRESSED:
+			data.assign(comp, comp + comp_len);
+			break;
+		case region_chunk_info::LZ4:
+			lz4_decoder::decode(comp, comp_len, data);
+			break;
+		default: throw region_file_exc(region_file_exc::UNKNOWN_COMPRESSION, chunk_info.get_type());
+			break;
+	}
+}
 
-	// read data from file
-	std::vector<int8_t> comp_vec;
-	int8_t comp_buff[comp_size];
-	chunk_file.seekg(chunk_info.get_position(), std::ios::beg);
-	chunk_file.read((char *) comp_buff, comp_size);
-	comp_vec.assign(comp_buff, comp_buff + comp_size);
+/*
+ * Returns the dense block ids & block data of an anvil chunk at a given x, z coord
+ */
+unsigned int region_file::get_chunk_blocks(unsigned int x, unsigned int z, std::vector<uint16_t> &blocks, std::vector<int8_t> &data) {
+	uint64_t comp_len;
+	const int8_t *comp = NULL;
+	region_chunk_info chunk_info = read_chunk_data(x, z, comp, comp_len);
 
-	// close file
-	chunk_file.close();
+	// uncompressed data is decoded in place (no copy)
+	if(chunk_info.get_type() == region_chunk_info::UNCOMPRESSED)
+		return region_section_decoder::decode(comp, comp_len, blocks, data);
 
-	// decompress data
+	// collect chunk data into the reusable buffer
 	switch(chunk_info.get_type()) {
 		case region_chunk_info::GZIP:
-			throw region_file_exc(region_file_exc::UNSUPPORTED_COMPRESSION, chunk_info.get_type());
-			break;
 		case region_chunk_info::ZLIB:
-			inflate_zlib(comp_vec, data);
+			inflater->inflate(chunk_info.get_type(), comp, comp_len, chunk_buff);
+			break;
+		case region_chunk_info::LZ4:
+			lz4_decoder::decode(comp, comp_len, chunk_buff);
 			break;
 		default: throw region_file_exc(region_file_exc::UNKNOWN_COMPRESSION, chunk_info.get_type());
 			break;
 	}
+
+	// decode sections straight from the chunk data (no tag tree)
+	return region_section_decoder::decode(chunk_buff.data(), chunk_buff.size(), blocks, data);
 }
 
 /*
@@ -191,147 +231,369 @@ void region_file::get_chunk_info(unsigned int x, unsigned int z, region_chunk_in
 		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, coord_vec);
 	}
 
-	// assign chunk info
+	// assign chunk info (reading its header on first access)
+	read_chunk_header(x + z * REGION_SIZE);
 	info = region_chunk_info(this->info[x + z * REGION_SIZE]);
 }
 
+/*
+ * Returns fill status at a given x, z coord
+ */
+bool region_file::is_filled(unsigned int x, unsigned int z) {
+
+	// check if x, z coord are out-of-bounds
+	if(x + z * REGION_SIZE >= CHUNK_COUNT) {
+		unsigned int coord[] = {x, z};
+		std::vector<unsigned int> coord_vec(coord, coord + 2);
+		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, coord_vec);
+	}
+	return info[x + z * REGION_SIZE].get_position();
+}
+
+/*
+ * Returns a chunks flat tape at a given x, z coord
+ */
+void region_file::get_chunk_tape(unsigned int x, unsigned int z, region_chunk_tape &tape) {
+	uint64_t comp_len;
+	const int8_t *comp = NULL;
+	region_chunk_info chunk_info = read_chunk_data(x, z, comp, comp_len);
+
+	// collect chunk data into the tapes buffer
+	switch(chunk_info.get_type()) {
+		case region_chunk_info::GZIP:
+		case region_chunk_info::ZLIB:
+			inflater->inflate(chunk_info.get_type(), comp, comp_len, tape.data);
+			break;
+		case region_chunk_info::LZ4:
+			lz4_decoder::decode(comp, comp_len, tape.data);
+			break;
+		case region_chunk_info::UNCOMPRESSED:
+			tape.data.assign(comp, comp + comp_len);
+			break;
+		default: throw region_file_exc(region_file_exc::UNKNOWN_COMPRESSION, chunk_info.get_type());
+			break;
+	}
+	tape.parse();
+}
+
 /*
  * Returns chunk data tag at a given x, z coord
  */
 void region_file::get_chunk_tag(unsigned int x, unsigned int z, region_chunk_tag &tag) {
+	uint64_t comp_len;
+	const int8_t *comp = NULL;
 
-	// collect chunk data
-	int8_t type;
-	std::vector<int8_t> data;
-	get_chunk_data(x, z, data);
+	// collect compressed chunk data
+	region_chunk_info chunk_info = read_chunk_data(x, z, comp, comp_len);
+	get_chunk_tag(chunk_info, comp, comp_len, tag);
+}
 
-	// setup stream from data
-	byte_stream stream(data);
-	stream << byte_stream::NO_SWAP_ENDIAN;
+/*
+ * Returns chunk data tag from a chunks compressed payload
+ */
+void region_file::get_chunk_tag(region_chunk_info &chunk_info, const int8_t *comp, uint64_t comp_len, region_chunk_tag &tag) {
 
-	// parse data for tags
-	stream >> type;
+	// check for a supported compression type
+	switch(chunk_info.get_type()) {
+		case region_chunk_info::GZIP:
+		case region_chunk_info::ZLIB:
+		case region_chunk_info::UNCOMPRESSED:
+		case region_chunk_info::LZ4:
+			break;
+		default: throw region_file_exc(region_file_exc::UNKNOWN_COMPRESSION, chunk_info.get_type());
+			break;
+	}
+
+	// uncompressed data is parsed in place (no copy)
+	if(chunk_info.get_type() == region_chunk_info::UNCOMPRESSED) {
+		byte_stream stream(const_cast<int8_t *>(comp), comp_len);
+		stream << byte_stream::NO_SWAP_ENDIAN;
+		read_root(stream, tag);
+		return;
+	}
 
-	// cleanup and assign new tag
-	region_chunk_tag::cleanup(tag.get_root_tag());
-	tag.get_root_tag() = NULL;
-	if(type == generic_tag::END)
-		tag.get_root_tag() = new end_tag;
-	else {
-		int8_t ch;
-		int16_t name_len;
-		stream >> name_len;
-		std::string name;
-		for(int i = 0; i < name_len; i++) {
-			stream >> ch;
-			name += ch;
+	// inflate and parse data in step through a fixed window
+	if(streaming
+			&& chunk_info.get_type() != region_chunk_info::LZ4) {
+		byte_stream_source *source = inflater->open(chunk_info.get_type(), comp, comp_len);
+		try {
+			byte_stream stream(*source);
+			stream << byte_stream::NO_SWAP_ENDIAN;
+			read_root(stream, tag);
+		} catch(...) {
+			delete source;
+			throw;
 		}
-		tag.get_root_tag() = read_tag(name, type, stream);
+		delete source;
+		return;
 	}
+
+	// collect chunk data into the reusable buffer
+	if(chunk_info.get_type() == region_chunk_info::LZ4)
+		lz4_decoder::decode(comp, comp_len, chunk_buff);
+	else
+		inflater->inflate(chunk_info.get_type(), comp, comp_len, chunk_buff);
+
+	// setup stream as a view over data (no copy)
+	byte_stream stream(chunk_buff.data(), chunk_buff.size());
+	stream << byte_stream::NO_SWAP_ENDIAN;
+	read_root(stream, tag);
 }
 
 /*
- * ZLib inflation routine
+ * Returns chunk data tag at a given x, z coord, read for a query
  */
-void region_file::inflate_zlib(std::vector<int8_t> &in, std::vector<int8_t> &out) {
-	z_stream str;
-	int ret, pos = 0;
+void region_file::get_chunk_tag(unsigned int x, unsigned int z, const region_chunk_query &query, region_chunk_tag &tag) {
+	uint64_t comp_len;
+	const int8_t *comp = NULL;
+	region_chunk_query resolved;
+
+	// collect compressed chunk data
+	region_chunk_info chunk_info = read_chunk_data(x, z, comp, comp_len);
+
+	// parse only the subtrees the query touches (a name not yet pooled may
+	// first appear in this chunk, so those queries read the whole tree)
+	this->query = &query;
+	if(!query.resolved()) {
+		resolved = query;
+		this->query = resolved.resolve() ? &resolved : NULL;
+	}
+	try {
+		get_chunk_tag(chunk_info, comp, comp_len, tag);
+	} catch(...) {
+		this->query = NULL;
+		throw;
+	}
+	this->query = NULL;
+}
 
-	// setup zlib object
-	str.zalloc = Z_NULL;
-	str.zfree = Z_NULL;
-	str.opaque = Z_NULL;
-	str.avail_in = 0;
-	str.next_in = Z_NULL;
+/*
+ * Maps a region file into memory (read-only)
+ */
+void region_file::map_file(const std::string &path) {
+	int fd;
+	struct stat st;
+	void *addr;
 
-	// begin inflation
-	ret = inflateInit(&str);
-	do {
-		int size = SEGMENT_SIZE;
-		if((unsigned int) (in.size() - pos) < SEGMENT_SIZE)
-			size = in.size() - pos;
-		int8_t in_buff[size];
-		int8_t out_buff[size];
-		for(int i = 0; i < size; i++)
-			in_buff[i] = in.at(pos + i);
-		str.avail_in = size;
-		str.next_in = (Bytef *) in_buff;
-		do {
-			str.avail_out = size;
-			str.next_out = (Bytef *) out_buff;
-			ret = inflate(&str, Z_NO_FLUSH);
-			for(int i = 0; i < size; i++)
-				out.push_back(out_buff[i]);
-		} while(str.avail_out == 0);
-		pos += size;
-	} while(ret != Z_STREAM_END);
-
-	// end inflation
-	inflateEnd(&str);
+	// open file at path
+	unmap_file();
+	fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+		throw region_file_exc(region_file_exc::INVALID_PATH, path);
+	if(fstat(fd, &st)
+			|| st.st_size < (off_t) HEADER_SIZE) {
+		::close(fd);
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, path);
+	}
+
+	// the mapping outlives the descriptor
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if(addr == MAP_FAILED)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, path);
+	map = static_cast<int8_t *>(addr);
+	map_len = st.st_size;
+}
+
+/*
+ * Opens the region files descriptor (read-only)
+ */
+void region_file::open_file(const std::string &path) {
+	close_file();
+	fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+		throw region_file_exc(region_file_exc::INVALID_PATH, path);
 }
 
 /*
  * Reads in a series of region chunks from a given path
  */
 void region_file::read(const std::string &path) {
-	int pos[CHUNK_COUNT];
-	int time[CHUNK_COUNT];
+	int8_t header[HEADER_SIZE];
 
-	// open file at path
-	file.open(path.c_str(), std::ios::in | std::ios::binary);
+	// decode header directly from the mapping
+	if(access == MAP) {
+		map_file(path);
+		read_header(map);
+		return;
+	}
 
-	// check if file exists
-	if(!file)
-		throw region_file_exc(region_file_exc::INVALID_PATH, path);
+	// open file at path (kept open for chunk reads)
+	open_file(path);
 
-	// read in chunk positions & convert to little-endian
-	for(unsigned int i = 0; i < CHUNK_COUNT; ++i) {
-		file.read(reinterpret_cast<char *>(&pos[i]), sizeof(int));
-		convert_endian(pos[i]);
+	// read in chunk locations & timestamps with a single read
+	if(read_file(header, HEADER_SIZE, 0) != HEADER_SIZE)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, path);
+	read_header(header);
+}
 
-		// increment filled if chunk is not empty
-		if(pos[i] != 0)
-			filled++;
+/*
+ * Reads region chunk data at a given x, z coord
+ */
+region_chunk_info region_file::read_chunk_data(unsigned int x, unsigned int z, const int8_t *&data, uint64_t &len) {
+	uint64_t count, offset, span;
+	unsigned int pos = x + z * REGION_SIZE;
+
+	// check if x, z coord are out-of-bounds
+	if(pos >= CHUNK_COUNT) {
+		unsigned int coord[] = {x, z};
+		std::vector<unsigned int> coord_vec(coord, coord + 2);
+		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, coord_vec);
 	}
 
-	// read in chunk timestamps & covert to little-endian
-	for(unsigned int i = 0; i < CHUNK_COUNT; ++i) {
-		file.read(reinterpret_cast<char *>(&time[i]), sizeof(int));
-		convert_endian(time[i]);
+	// check if x, z coord is filled
+	if(!region_chunk_info(this->info[pos]).get_position()) {
+		unsigned int coord[] = {x, z};
+		std::vector<unsigned int> coord_vec(coord, coord + 2);
+		throw region_file_exc(region_file_exc::UNFILLED_CHUNK, coord_vec);
 	}
+	offset = info[pos].get_position() - CHUNK_HEADER_SIZE;
+	data = NULL;
+	len = 0;
+
+	// fetch chunk header & payload with a single read on first access
+	if(!map
+			&& info[pos].get_type() == region_chunk_info::UNDEFINED) {
+		span = std::max<uint64_t>((uint64_t) info[pos].get_sectors() * SECTOR_SIZE, CHUNK_HEADER_SIZE);
+		comp_buff.resize(span);
+		count = read_file(comp_buff.data(), span, offset);
+		if(count < CHUNK_HEADER_SIZE)
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, offset);
+		info[pos].set_size(byte_order::load<uint32_t>(comp_buff.data(), false));
+		info[pos].set_type((uint8_t) comp_buff[sizeof(int32_t)]);
+		data = comp_buff.data() + CHUNK_HEADER_SIZE;
+		len = count - CHUNK_HEADER_SIZE;
+	} else
+		read_chunk_header(pos);
 
-	// add chunks to array
-	for(unsigned int i = 0; i < CHUNK_COUNT; i++) {
-		int size = 0;
-		char comp_type = 0;
-		region_chunk_info chunk_info;
-
-		// retrieve chunk size, compression type, & data if chunk exists
-		if(pos[i] != 0) {
-			file.seekg(0, std::ios::beg);
-			file.seekg((pos[i] >> 8) * SECTOR_SIZE, std::ios::cur);
-			file.read(reinterpret_cast<char *>(&size), sizeof(int));
-			convert_endian(size);
-			file.read(&comp_type, sizeof(char));
-			pos[i] = file.tellg();
-			chunk_info = region_chunk_info(comp_type, size, pos[i], time[i]);
-		}
+	// gather chunk info
+	region_chunk_info chunk_info = info[pos];
 
-		// create all chunks
-		info[i] = chunk_info;
+	// chunk length includes the compression type byte
+	uint64_t comp_size = chunk_info.get_size() ? chunk_info.get_size() - 1 : 0;
+
+	// check for a supported compression type
+	switch(chunk_info.get_type()) {
+		case region_chunk_info::GZIP:
+		case region_chunk_info::ZLIB:
+		case region_chunk_info::UNCOMPRESSED:
+		case region_chunk_info::LZ4:
+			break;
+		default: throw region_file_exc(region_file_exc::UNKNOWN_COMPRESSION, chunk_info.get_type());
+			break;
+	}
+
+	// a payload never extends past its sectors (bounds corrupt lengths)
+	if(comp_size + CHUNK_HEADER_SIZE > (uint64_t) chunk_info.get_sectors() * SECTOR_SIZE)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, chunk_info.get_position());
+
+	// point into the mapping (no read, no copy)
+	if(map) {
+		if(chunk_info.get_position() + comp_size > map_len)
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, chunk_info.get_position());
+		data = map + chunk_info.get_position();
+		len = comp_size;
+		return chunk_info;
 	}
 
-	// close file
-	file.close();
+	// payload already read along with the chunk header
+	if(data
+			&& comp_size <= len) {
+		len = comp_size;
+		return chunk_info;
+	}
+
+	// positioned read into the reusable buffer (no seek state)
+	comp_buff.resize(comp_size);
+	if(read_file(comp_buff.data(), comp_size, chunk_info.get_position()) != comp_size)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, chunk_info.get_position());
+	data = comp_buff.data();
+	len = comp_size;
+	return chunk_info;
+}
+
+/*
+ * Reads a region chunk header (length & compression type) if not yet read
+ */
+void region_file::read_chunk_header(unsigned int pos) {
+	uint64_t offset;
+	const int8_t *header;
+	int8_t buff[CHUNK_HEADER_SIZE];
+
+	// check if chunk is empty or already read
+	if(!info[pos].get_position()
+			|| info[pos].get_type() != region_chunk_info::UNDEFINED)
+		return;
+	offset = info[pos].get_position() - CHUNK_HEADER_SIZE;
+
+	// decode from the mapping or a positioned read
+	if(map) {
+		if(offset + CHUNK_HEADER_SIZE > map_len)
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, offset);
+		header = map + offset;
+	} else {
+		if(read_file(buff, CHUNK_HEADER_SIZE, offset) != CHUNK_HEADER_SIZE)
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, offset);
+		header = buff;
+	}
+	info[pos].set_size(byte_order::load<uint32_t>(header, false));
+	info[pos].set_type((uint8_t) header[sizeof(int32_t)]);
+}
+
+/*
+ * Reads up to len bytes at a given file offset
+ * (positioned reads, retried until complete or the file ends)
+ */
+uint64_t region_file::read_file(int8_t *data, uint64_t len, uint64_t offset) {
+	ssize_t count;
+	uint64_t total = 0;
+
+	while(total < len) {
+		count = pread(fd, data + total, len - total, offset + total);
+		if(count < 0
+				&& errno == EINTR)
+			continue;
+		if(count < 0)
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, offset + total);
+		if(!count)
+			break;
+		total += count;
+	}
+	return total;
+}
+
+/*
+ * Decodes the region header from a buffer
+ * (chunk lengths & compression types are read lazily)
+ */
+void region_file::read_header(const int8_t *data) {
+	uint32_t loc;
+	region_chunk_info chunk_info;
+
+	// decode chunk locations & timestamps (big-endian)
+	filled = 0;
+	for(unsigned int i = 0; i < CHUNK_COUNT; ++i) {
+		loc = byte_order::load<uint32_t>(data + i * sizeof(int32_t), false);
+		chunk_info = region_chunk_info();
+
+		// chunk payload follows its length & compression type
+		if(loc) {
+			chunk_info = region_chunk_info(region_chunk_info::UNDEFINED, 0,
+					(loc >> 8) * SECTOR_SIZE + CHUNK_HEADER_SIZE,
+					byte_order::load<int32_t>(data + (CHUNK_COUNT + i) * sizeof(int32_t), false),
+					loc & 0xff);
+			filled++;
+		}
+		info[i] = chunk_info;
+	}
 }
 
 /*
  * Reads a compound tag value from stream
  */
 void region_file::read_compound_value(byte_stream &stream, std::vector<generic_tag *> &value) {
-	int16_t name_len;
-	int8_t ch, ele_type;
-	std::string name;
+	int8_t ele_type;
+	uint32_t name;
 
 	// check stream status
 	if(!stream.good())
@@ -339,14 +601,10 @@ void region_file::read_compound_value(byte_stream &stream, std::vector<generic_t
 
 	// retrieve compound value
 	do {
-		stream >> ele_type;
+		if(!(stream >> ele_type))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
 		if(ele_type != generic_tag::END) {
-			stream >> name_len;
-			name.clear();
-			for(int i = 0; i < name_len; i++) {
-				stream >> ch;
-				name += ch;
-			}
+			name = read_tag_name(stream);
 			value.push_back(read_tag(name, ele_type, stream));
 		}
 	} while(ele_type != generic_tag::END);
@@ -355,45 +613,226 @@ void region_file::read_compound_value(byte_stream &stream, std::vector<generic_t
 /*
  * Reads a list tag value from stream
  */
-void region_file::read_list_value(byte_stream &stream, std::vector<generic_tag *> &value) {
+void region_file::read_list_value(byte_stream &stream, std::vector<generic_tag *> &value, int8_t &ele_type) {
 	int32_t len;
-	int8_t ele_type;
 
 	// check stream status
 	if(!stream.good())
 		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
 
 	// retrieve list value
-	stream >> ele_type;
-	stream >> len;
-	len = abs(len);
-	for(int i = 0; i < len; i++)
-		value.push_back(read_tag("", ele_type, stream));
+	if(!(stream >> ele_type)
+			|| !(stream >> len)
+			|| len < 0)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+	switch(ele_type) {
+		case generic_tag::DOUBLE:
+			read_number_list<double, double_tag>(stream, len, value);
+			break;
+		case generic_tag::FLOAT:
+			read_number_list<float, float_tag>(stream, len, value);
+			break;
+		default:
+			for(int i = 0; i < len; i++)
+				value.push_back(read_tag(tag_name_pool::EMPTY, ele_type, stream));
+			break;
+	}
+}
+
+/*
+ * Reads a compound tag value from stream for a query step
+ */
+void region_file::read_query_compound_value(byte_stream &stream, std::vector<generic_tag *> &value, unsigned int op, uint32_t keep) {
+	int8_t ele_type;
+	uint32_t name;
+	const region_chunk_query::step &st = query->steps[op];
+
+	// check stream status
+	if(!stream.good())
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+
+	// retrieve selected children (others are skipped)
+	do {
+		if(!(stream >> ele_type))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+		if(ele_type != generic_tag::END) {
+			name = read_tag_name(stream);
+			if(name == keep)
+				value.push_back(read_tag(name, ele_type, stream));
+			else if(st.type == region_chunk_query::ALL
+					|| (st.type == region_chunk_query::CHILD && st.name == name))
+				value.push_back(read_query_tag(name, ele_type, stream, op + 1, tag_name_pool::NONE));
+			else
+				skip_tag(ele_type, stream);
+		}
+	} while(ele_type != generic_tag::END);
+}
+
+/*
+ * Reads a list tag value from stream for a query step
+ */
+void region_file::read_query_list_value(byte_stream &stream, std::vector<generic_tag *> &value, unsigned int op) {
+	int32_t len;
+	int8_t ele_type;
+	const region_chunk_query::step &st = query->steps[op];
+
+	// check stream status
+	if(!stream.good())
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+
+	// retrieve selected elements (others are skipped)
+	if(!(stream >> ele_type)
+			|| !(stream >> len)
+			|| len < 0)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+	for(int32_t i = 0; i < len; ++i)
+		switch(st.type) {
+			case region_chunk_query::ALL:
+				value.push_back(read_query_tag(tag_name_pool::EMPTY, ele_type, stream, op + 1, tag_name_pool::NONE));
+				break;
+			case region_chunk_query::INDEX:
+
+				// earlier elements are left empty (keeping element indices)
+				if(i < (int64_t) st.index) {
+					skip_tag(ele_type, stream);
+					if(ele_type == generic_tag::LIST)
+						value.push_back(new (arena) list_tag(tag_name_pool::EMPTY, arena));
+					else
+						value.push_back(new (arena) compound_tag(tag_name_pool::EMPTY, arena));
+				} else if(i == (int64_t) st.index)
+					value.push_back(read_query_tag(tag_name_pool::EMPTY, ele_type, stream, op + 1, tag_name_pool::NONE));
+				else
+					skip_tag(ele_type, stream);
+				break;
+			case region_chunk_query::MATCH_STRING:
+			case region_chunk_query::MATCH_NUMBER:
+
+				// elements keep their key, to be matched once read
+				value.push_back(read_query_tag(tag_name_pool::EMPTY, ele_type, stream, op + 1, st.name));
+				break;
+			default:
+				skip_tag(ele_type, stream);
+				break;
+		}
+}
+
+/*
+ * Creates a tag from stream for a query step
+ */
+generic_tag *region_file::read_query_tag(uint32_t name, unsigned int type, byte_stream &stream, unsigned int op, uint32_t keep) {
+	generic_tag *tag = NULL;
+	uint64_t mark = tag_buff.size();
+
+	// values past the last step (or without children) are read whole
+	if(op >= query->steps.size()
+			|| (type != generic_tag::COMPOUND && type != generic_tag::LIST))
+		return read_tag(name, type, stream);
+
+	// lists of values are small, so they are read whole too
+	if(type == generic_tag::LIST) {
+		int8_t ele_type;
+		if(!stream.peek(ele_type))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+		if(ele_type != generic_tag::COMPOUND
+				&& ele_type != generic_tag::LIST)
+			return read_tag(name, type, stream);
+		read_query_list_value(stream, tag_buff, op);
+		tag = new (arena) list_tag(name, arena);
+		static_cast<list_tag *>(tag)->set_element_type(ele_type);
+		static_cast<list_tag *>(tag)->value.assign(tag_buff.begin() + mark, tag_buff.end());
+	} else {
+		read_query_compound_value(stream, tag_buff, op, keep);
+		tag = new (arena) compound_tag(name, arena);
+		static_cast<compound_tag *>(tag)->value.assign(tag_buff.begin() + mark, tag_buff.end());
+	}
+	tag_buff.resize(mark);
+	return tag;
+}
+
+/*
+ * Reads the root tag from stream
+ */
+void region_file::read_root(byte_stream &stream, region_chunk_tag &tag) {
+	int8_t type;
+
+	// parse data for tags
+	stream >> type;
+
+	// cleanup and assign new tag (allocated from the tags arena)
+	tag.cleanup();
+	arena = &tag.get_arena();
+	tag_buff.clear();
+	try {
+		if(type == generic_tag::END)
+			tag.get_root_tag() = new (arena) end_tag(arena);
+		else {
+			uint32_t name = read_tag_name(stream);
+			if(query)
+				tag.get_root_tag() = read_query_tag(name, type, stream, 0, tag_name_pool::NONE);
+			else
+				tag.get_root_tag() = read_tag(name, type, stream);
+		}
+	} catch(...) {
+
+		// a partial tree is freed with the arena
+		arena = NULL;
+		tag.get_root_tag() = NULL;
+		tag.cleanup();
+		throw;
+	}
+	arena = NULL;
 }
 
 /*
  * Reads a string tag value from stream
  */
 void region_file::read_string_value(byte_stream &stream, std::string &value) {
-	int8_t ch;
 	int16_t str_len;
 
 	// check stream status
 	if(!stream.good())
 		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
 
-	// retrieve string value
+	// retrieve string value (in a single pass)
 	stream >> str_len;
-	for(int i = 0; i < str_len; i++) {
-		stream >> ch;
-		value += ch;
+	if(str_len <= 0)
+		return;
+	value.resize(str_len);
+	if(!stream.read(reinterpret_cast<int8_t *>(&value[0]), str_len))
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+}
+
+/*
+ * Reads a tag name from stream
+ */
+uint32_t region_file::read_tag_name(byte_stream &stream) {
+	int16_t name_len;
+	const int8_t *name;
+
+	// check stream status
+	if(!(stream >> name_len))
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+	if(name_len <= 0)
+		return tag_name_pool::EMPTY;
+
+	// buffered names are resolved in place (no copy)
+	if(stream.is_streaming()) {
+		name_buff.resize(name_len);
+		if(!stream.read(name_buff.data(), name_len))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+		name = name_buff.data();
+	} else {
+		name = stream.rdbuf() + stream.position();
+		if(!stream.skip(name_len))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
 	}
+	return names.intern(reinterpret_cast<const char *>(name), name_len);
 }
 
 /*
  * Creates a tag from stream
  */
-generic_tag *region_file::read_tag(const std::string &name, unsigned int type, byte_stream &stream) {
+generic_tag *region_file::read_tag(uint32_t name, unsigned int type, byte_stream &stream) {
 
 	// create tag
 	generic_tag *tag = NULL;
@@ -404,53 +843,65 @@ generic_tag *region_file::read_tag(const std::string &name, unsigned int type, b
 	float f_val;
 	double d_val;
 	std::string str_val;
-	std::vector<int8_t> b_vec;
-	std::vector<generic_tag *> gen_vec;
+	uint64_t mark = tag_buff.size();
 
 	// assign tag based off type
 	switch(type) {
 		case generic_tag::BYTE:
 			read_number_value<int8_t>(stream, b_val);
-			tag = new byte_tag(name, b_val);
+			tag = new (arena) byte_tag(name, b_val, arena);
 			break;
 		case generic_tag::BYTE_ARRAY:
-			read_array_value<int8_t>(stream, b_vec);
-			tag = new byte_array_tag(name, b_vec);
+
+			// read directly into the tag to avoid copying the array
+			tag = new (arena) byte_array_tag(name, arena);
+			read_array_value<int8_t>(stream, static_cast<byte_array_tag *>(tag)->value);
 			break;
 		case generic_tag::COMPOUND:
-			read_compound_value(stream, gen_vec);
-			tag = new compound_tag(name, gen_vec);
+			read_compound_value(stream, tag_buff);
+			tag = new (arena) compound_tag(name, arena);
+			static_cast<compound_tag *>(tag)->value.assign(tag_buff.begin() + mark, tag_buff.end());
+			tag_buff.resize(mark);
 			break;
 		case generic_tag::DOUBLE:
 			read_number_value<double>(stream, d_val);
-			tag = new double_tag(name, d_val);
+			tag = new (arena) double_tag(name, d_val, arena);
 			break;
 		case generic_tag::END:
-			tag = new end_tag;
+			tag = new (arena) end_tag(arena);
 			break;
 		case generic_tag::FLOAT:
 			read_number_value<float>(stream, f_val);
-			tag = new float_tag(name, f_val);
+			tag = new (arena) float_tag(name, f_val, arena);
 			break;
 		case generic_tag::INT:
 			read_number_value<int32_t>(stream, i_val);
-			tag = new int_tag(name, i_val);
+			tag = new (arena) int_tag(name, i_val, arena);
+			break;
+		case generic_tag::INT_ARRAY:
+
+			// read directly into the tag to avoid copying the array
+			tag = new (arena) int_array_tag(name, arena);
+			read_array_value<int32_t>(stream, static_cast<int_array_tag *>(tag)->value);
 			break;
 		case generic_tag::LIST:
-			read_list_value(stream, gen_vec);
-			tag = new list_tag(name, gen_vec);
+			read_list_value(stream, tag_buff, b_val);
+			tag = new (arena) list_tag(name, arena);
+			static_cast<list_tag *>(tag)->set_element_type(b_val);
+			static_cast<list_tag *>(tag)->value.assign(tag_buff.begin() + mark, tag_buff.end());
+			tag_buff.resize(mark);
 			break;
 		case generic_tag::LONG:
 			read_number_value<int64_t>(stream, l_val);
-			tag = new long_tag(name, l_val);
+			tag = new (arena) long_tag(name, l_val, arena);
 			break;
 		case generic_tag::SHORT:
 			read_number_value<int16_t>(stream, s_val);
-			tag = new short_tag(name, s_val);
+			tag = new (arena) short_tag(name, s_val, arena);
 			break;
 		case generic_tag::STRING:
 			read_string_value(stream, str_val);
-			tag = new string_tag(name, str_val);
+			tag = new (arena) string_tag(name, str_val, arena);
 			break;
 		default:
 			throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, type);
@@ -458,6 +909,62 @@ generic_tag *region_file::read_tag(const std::string &name, unsigned int type, b
 	return tag;
 }
 
+/*
+ * Skips over a tag value in stream without creating it
+ */
+void region_file::skip_tag(unsigned int type, byte_stream &stream) {
+	int8_t ele_type;
+	int16_t name_len, str_len;
+	int32_t len;
+	bool result = true;
+
+	// skip tag based off type
+	switch(type) {
+		case generic_tag::BYTE:
+		case generic_tag::DOUBLE:
+		case generic_tag::FLOAT:
+		case generic_tag::INT:
+		case generic_tag::LONG:
+		case generic_tag::SHORT:
+			result = stream.skip(generic_tag::type_width(type));
+			break;
+		case generic_tag::BYTE_ARRAY:
+			result = (stream >> len) && len >= 0 && stream.skip(len);
+			break;
+		case generic_tag::INT_ARRAY:
+			result = (stream >> len) && len >= 0 && stream.skip((uint64_t) len * sizeof(int32_t));
+			break;
+		case generic_tag::COMPOUND:
+			while((result = stream >> ele_type)
+					&& ele_type != generic_tag::END) {
+				if(!(result = (stream >> name_len) && stream.skip(name_len)))
+					break;
+				skip_tag(ele_type, stream);
+			}
+			break;
+		case generic_tag::END:
+			break;
+		case generic_tag::LIST:
+			if(!(result = (stream >> ele_type) && (stream >> len) && len >= 0))
+				break;
+			if(generic_tag::type_width(ele_type))
+				result = stream.skip((uint64_t) len * generic_tag::type_width(ele_type));
+			else
+				for(int i = 0; i < len; ++i)
+					skip_tag(ele_type, stream);
+			break;
+		case generic_tag::STRING:
+			result = (stream >> str_len) && stream.skip(str_len);
+			break;
+		default:
+			throw region_file_exc(region_file_exc::UNKNOWN_TAG_TYPE, type);
+	}
+
+	// check stream status
+	if(!result)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+}
+
 /*
  * Returns a string representation of a region file
  */
@@ -468,3 +975,13 @@ std::string region_file::to_string(void) {
 	ss << "[REGION] (" << x << ", " << z << "), filled: " << filled << "/" << CHUNK_COUNT << ", path: " << path;
 	return ss.str();
 }
+
+/*
+ * Unmaps a region file from memory
+ */
+void region_file::unmap_file(void) {
+	if(map)
+		munmap(map, map_len);
+	map = NULL;
+	map_len = 0;
+}
@@ -20,13 +20,17 @@
 #ifndef REGION_FILE_HPP_
 #define REGION_FILE_HPP_
 
+#include <algorithm>
 #include <boost/regex.hpp>
 #include <cstdint>
-#include <fstream>
 #include <string>
 #include <vector>
 #include "byte_stream.hpp"
+#include "inflate_backend.hpp"
+#include "lz4_decoder.hpp"
 #include "region_chunk_info.hpp"
+#include "region_chunk_query.hpp"
+#include "region_chunk_tape.hpp"
 #include "region_chunk_tag.hpp"
 #include "region_file_exc.hpp"
 #include "tag/byte_array_tag.hpp"
@@ -36,6 +40,7 @@
 #include "tag/end_tag.hpp"
 #include "tag/float_tag.hpp"
 #include "tag/generic_tag.hpp"
+#include "tag/int_array_tag.hpp"
 #include "tag/int_tag.hpp"
 #include "tag/list_tag.hpp"
 #include "tag/long_tag.hpp"
@@ -46,9 +51,15 @@ class region_file {
 private:
 
 	/*
-	 * ZLib inflation segment size
+	 * Batch reads fetch chunks through the region files descriptor/mapping
 	 */
-	static const unsigned int SEGMENT_SIZE = 16384;
+	friend class region_batch_reader;
+	friend class region_compactor;
+
+	/*
+	 * Section decoding skips unused tags in place
+	 */
+	friend class region_section_decoder;
 
 	/*
 	 * Array of chunk files
@@ -56,15 +67,81 @@ private:
 	region_chunk_info *info;
 
 	/*
-	 * Region file
+	 * Reusable compressed/decompressed chunk buffers
+	 * (grown as needed and kept across chunk reads)
+	 */
+	std::vector<int8_t> comp_buff, chunk_buff;
+
+	/*
+	 * Arena of the chunk tag being read
+	 * (set while a root tag is parsed)
+	 */
+	tag_arena *arena;
+
+	/*
+	 * Reusable child tag stack
+	 * (compound & list children are collected here, then copied into their arena)
+	 */
+	std::vector<generic_tag *> tag_buff;
+
+	/*
+	 * Query of the chunk tag being read
+	 * (set while a chunk is read for a query, only touched subtrees are created)
+	 */
+	const region_chunk_query *query;
+
+	/*
+	 * Tag names seen by this reader
+	 * (resolves repeated names to pooled ids without locking the pool)
+	 */
+	tag_name_cache names;
+
+	/*
+	 * Reusable tag name buffer
+	 * (names are read in place unless streaming)
 	 */
-	std::ifstream file;
+	std::vector<int8_t> name_buff;
+
+	/*
+	 * Region file descriptor
+	 * (READ access only, kept open for positioned chunk reads)
+	 */
+	int fd;
+
+	/*
+	 * Region file mapping/length
+	 * (MAP access only, NULL otherwise)
+	 */
+	int8_t *map;
+	uint64_t map_len;
+
+	/*
+	 * Region file access mode
+	 */
+	unsigned int access;
+
+	/*
+	 * Region file format
+	 */
+	unsigned int format;
+
+	/*
+	 * Chunk decompression backend
+	 * (shared, defaults to the process-wide backend)
+	 */
+	inflate_backend *inflater;
 
 	/*
 	 * Number of chunks filled
 	 */
 	unsigned int filled;
 
+	/*
+	 * Streaming mode
+	 * (chunks are parsed while they inflate, through a fixed window)
+	 */
+	bool streaming;
+
 	/*
 	 * Region file path
 	 */
@@ -75,37 +152,55 @@ private:
 	 */
 	int x, z;
 
+	/*
+	 * Closes the region files descriptor
+	 */
+	void close_file(void);
+
 	/*
 	 * Returnd region chunk data at a given x, z coord
 	 */
 	void get_chunk_data(unsigned int x, unsigned int z, std::vector<int8_t> &data);
 
 	/*
-	 * ZLib inflation routine
+	 * Reads compressed region chunk data at a given x, z coord
+	 * (into the reusable compressed buffer, or in place when mapped)
 	 */
-	void inflate_zlib(std::vector<int8_t> &in, std::vector<int8_t> &out);
+	region_chunk_info read_chunk_data(unsigned int x, unsigned int z, const int8_t *&data, uint64_t &len);
+
+	/*
+	 * Reads a region chunk header (length & compression type) if not yet read
+	 */
+	void read_chunk_header(unsigned int pos);
 
 	/*
 	 * Reads an array tag value from stream
 	 */
-	template <class T>
-	void read_array_value(byte_stream &stream, std::vector<T> &value) {
+	template <class T, class A>
+	void read_array_value(byte_stream &stream, std::vector<T, A> &value) {
 		int32_t len;
-		T byte_ele;
 
 		// check stream status
 		if(!stream.good())
 			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
 
-		// retrieve value
-		stream >> len;
-		len = abs(len);
-		for(int i = 0; i < len; ++i) {
-			stream >> byte_ele;
-			value.push_back(byte_ele);
-		}
+		// retrieve value (bulk copy & byte-swap)
+		if(!(stream >> len)
+				|| len < 0
+				|| !stream.read(value, len))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
 	}
 
+	/*
+	 * Maps a region file into memory (read-only)
+	 */
+	void map_file(const std::string &path);
+
+	/*
+	 * Opens the region files descriptor (read-only)
+	 */
+	void open_file(const std::string &path);
+
 	/*
 	 * Reads a compound tag value from stream
 	 */
@@ -113,8 +208,34 @@ private:
 
 	/*
 	 * Reads a list tag value from stream
+	 * (type is set to the lists element type)
 	 */
-	void read_list_value(byte_stream &stream, std::vector<generic_tag *> &value);
+	void read_list_value(byte_stream &stream, std::vector<generic_tag *> &value, int8_t &type);
+
+	/*
+	 * Reads a series of number tag values from stream in a single pass
+	 */
+	template <class T, class TAG>
+	void read_number_list(byte_stream &stream, int32_t len, std::vector<generic_tag *> &value) {
+		int32_t count;
+		std::vector<T> num(std::min<int32_t>(len, (int32_t) NUMBER_BLOCK_LEN));
+
+		// reject lengths past the end of the data (bounds corrupt lengths)
+		if(!stream.is_streaming()) {
+			if((uint64_t) len * sizeof(T) > stream.available())
+				throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+			value.reserve(value.size() + len);
+		}
+
+		// retrieve values a block at a time
+		for(int32_t i = 0; i < len; i += count) {
+			count = std::min<int32_t>(len - i, num.size());
+			if(!stream.read(num.data(), count))
+				throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+			for(int32_t j = 0; j < count; ++j)
+				value.push_back(new (arena) TAG(tag_name_pool::EMPTY, num[j], arena));
+		}
+	}
 
 	/*
 	 * Reads a number tag value from stream
@@ -130,6 +251,41 @@ private:
 		stream >> value;
 	}
 
+	/*
+	 * Reads a compound tag value from stream for a query step
+	 * (children the step does not select are skipped, keep names a child read whole)
+	 */
+	void read_query_compound_value(byte_stream &stream, std::vector<generic_tag *> &value, unsigned int op, uint32_t keep);
+
+	/*
+	 * Reads a list tag value from stream for a query step
+	 * (elements the step does not select are skipped)
+	 */
+	void read_query_list_value(byte_stream &stream, std::vector<generic_tag *> &value, unsigned int op);
+
+	/*
+	 * Creates a tag from stream for a query step
+	 * (compounds & lists hold only what the remaining steps touch)
+	 */
+	generic_tag *read_query_tag(uint32_t name, unsigned int type, byte_stream &stream, unsigned int op, uint32_t keep);
+
+	/*
+	 * Reads up to len bytes at a given file offset
+	 * (positioned reads, retried until complete or the file ends)
+	 */
+	uint64_t read_file(int8_t *data, uint64_t len, uint64_t offset);
+
+	/*
+	 * Decodes the region header from a buffer
+	 * (chunk lengths & compression types are read lazily)
+	 */
+	void read_header(const int8_t *data);
+
+	/*
+	 * Reads the root tag from stream
+	 */
+	void read_root(byte_stream &stream, region_chunk_tag &tag);
+
 	/*
 	 * Reads a string tag value from stream
 	 */
@@ -138,15 +294,59 @@ private:
 	/*
 	 * Creates a tag from stream
 	 */
-	generic_tag *read_tag(const std::string &name, unsigned int type, byte_stream &stream);
+	generic_tag *read_tag(uint32_t name, unsigned int type, byte_stream &stream);
+
+	/*
+	 * Reads a tag name from stream
+	 * (returns the names pooled id)
+	 */
+	uint32_t read_tag_name(byte_stream &stream);
+
+	/*
+	 * Skips over a tag value in stream without creating it
+	 * (fixed width lists & arrays are skipped in a single step)
+	 */
+	static void skip_tag(unsigned int type, byte_stream &stream);
+
+	/*
+	 * Unmaps a region file from memory
+	 */
+	void unmap_file(void);
 
 public:
 
+	/*
+	 * Region file access modes
+	 * (READ reads chunks from the file, MAP parses them in place from a mapping)
+	 */
+	enum ACCESS { READ, MAP };
+
+	/*
+	 * Region file formats
+	 * (MCREGION for .mcr files, ANVIL for .mca files)
+	 */
+	enum FORMAT { MCREGION, ANVIL };
+
+	/*
+	 * Region chunk header size (length & compression type)
+	 */
+	static const unsigned int CHUNK_HEADER_SIZE = 5;
+
 	/*
 	 * Region file chunk count
 	 */
 	static const unsigned int CHUNK_COUNT = 1024;
 
+	/*
+	 * Region file header size (chunk locations & timestamps)
+	 */
+	static const unsigned int HEADER_SIZE = 8192;
+
+	/*
+	 * Number list block length (elements read at a time)
+	 */
+	static const unsigned int NUMBER_BLOCK_LEN = 1024;
+
 	/*
 	 * Region file pattern
 	 */
@@ -175,12 +375,12 @@ public:
 	/*
 	 * Region file constructor
 	 */
-	region_file(const std::string &path);
+	region_file(const std::string &path, unsigned int access = READ);
 
 	/*
 	 * Region file destructor
 	 */
-	virtual ~region_file(void) { delete[] info; }
+	virtual ~region_file(void);
 
 	/*
 	 * Region file assignment
@@ -210,16 +410,56 @@ public:
 		std::reverse(endian, endian + sizeof(T));
 	}
 
+	/*
+	 * Returns the dense block ids & block data of an anvil chunk at a given x, z coord
+	 * (YZX order, 16 sections of 4096 blocks, returns a mask of the sections present)
+	 */
+	unsigned int get_chunk_blocks(unsigned int x, unsigned int z, std::vector<uint16_t> &blocks, std::vector<int8_t> &data);
+
 	/*
 	 * Returns region chunk information at a given x, z coord
+	 * (the chunks length & compression type are read on first access)
 	 */
 	void get_chunk_info(unsigned int x, unsigned int z, region_chunk_info &info);
 
+	/*
+	 * Returns a chunks flat tape at a given x, z coord
+	 * (read-only, built in a single pass into the tapes reused buffers)
+	 */
+	void get_chunk_tape(unsigned int x, unsigned int z, region_chunk_tape &tape);
+
 	/*
 	 * Returns chunk data tag at a given x, z coord
 	 */
 	void get_chunk_tag(unsigned int x, unsigned int z, region_chunk_tag &tag);
 
+	/*
+	 * Returns chunk data tag from a chunks compressed payload
+	 * (as fetched by a region_batch_reader)
+	 */
+	void get_chunk_tag(region_chunk_info &info, const int8_t *data, uint64_t len, region_chunk_tag &tag);
+
+	/*
+	 * Returns chunk data tag at a given x, z coord, read for a query
+	 * (subtrees the query does not touch are skipped, see region_chunk_query::run)
+	 */
+	void get_chunk_tag(unsigned int x, unsigned int z, const region_chunk_query &query, region_chunk_tag &tag);
+
+	/*
+	 * Returns the region files access mode
+	 */
+	unsigned int get_access(void) { return access; }
+
+	/*
+	 * Returns the region files decompression backend
+	 */
+	inflate_backend &get_inflate_backend(void) { return *inflater; }
+
+	/*
+	 * Returns the region files format
+	 */
+	unsigned int get_format(void) { return format; }
+
 	/*
 	 * Returns total region chunks filled within a region file
 	 */
@@ -240,6 +480,17 @@ public:
 	 */
 	int get_region_z_coord(void) { return z; }
 
+	/*
+	 * Returns fill status at a given x, z coord
+	 * (no file access)
+	 */
+	bool is_filled(unsigned int x, unsigned int z);
+
+	/*
+	 * Returns the streaming mode of a region file
+	 */
+	bool is_streaming(void) { return streaming; }
+
 	/*
 	 * Reads in a series of region chunks
 	 */
@@ -250,6 +501,18 @@ public:
 	 */
 	void read(const std::string &path);
 
+	/*
+	 * Sets the region files decompression backend
+	 * (the backend must outlive the region file)
+	 */
+	void set_inflate_backend(inflate_backend &inflater) { this->inflater = &inflater; }
+
+	/*
+	 * Sets the streaming mode of a region file
+	 * (bounds the inflated bytes held per chunk to a fixed window)
+	 */
+	void set_streaming(bool streaming) { this->streaming = streaming; }
+
 	/*
 	 * Returns a string representation of a region file
 	 */
@@ -32,7 +32,11 @@ const std::string region_file_exc::MESSAGE[MESSAGE_COUNT] = {
 		"Unknown tag type",
 		"Stream read error",
 		"Attempt to read unfilled chunk",
-		"Tag not found"
+		"Tag not found",
+		"Decompression failed",
+		"Compression failed",
+		"Stream write error",
+		"Invalid query"
 };
 
 /*
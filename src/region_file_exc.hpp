@@ -44,9 +44,9 @@ public:
 	 */
 	enum EXC_CODE { UNDEFINED, ALLOC_FAIL, INVALID_PATH, OUT_OF_BOUNDS, UNSUPPORTED_COMPRESSION,
 					UNKNOWN_COMPRESSION, UNKNOWN_TAG_TYPE, STREAM_READ_ERROR, UNFILLED_CHUNK,
-					TAG_NOT_FOUND, };
+					TAG_NOT_FOUND, DECOMPRESS_FAIL, COMPRESS_FAIL, STREAM_WRITE_ERROR, INVALID_QUERY, };
 	static const std::string MESSAGE[];
-	static const unsigned int MESSAGE_COUNT = 10;
+	static const unsigned int MESSAGE_COUNT = 14;
 
 	/*
 	 * Region file exception constructor
@@ -27,10 +27,10 @@
  * Supported tags
  */
 const std::string region_file_reader::TAGS[TAG_COUNT] = {
-		"Blocks",
-		"HeightMap",
-		"xPos",
-		"zPos",
+		"Level.Blocks",
+		"Level.HeightMap",
+		"Level.xPos",
+		"Level.zPos",
 };
 
 /*
@@ -46,7 +46,7 @@ region_file_reader::region_file_reader(void) : fill_count(0) {
 /*
  * Region file reader constructor
  */
-region_file_reader::region_file_reader(const region_file_reader &other): fill_count(other.fill_count), path(other.path) {
+region_file_reader::region_file_reader(const region_file_reader &other): fill_count(other.fill_count), file(other.file), path(other.path) {
 
 	// assign attribute values
 	for(unsigned int i = 0; i < region_file::CHUNK_COUNT; ++i) {
@@ -58,25 +58,16 @@ region_file_reader::region_file_reader(const region_file_reader &other): fill_co
 /*
  * Region file reader constructor
  */
-region_file_reader::region_file_reader(const std::string &path) : path(path) {
+region_file_reader::region_file_reader(const std::string &path) : fill_count(0), file(path), path(path) {
 	unsigned int pos;
-	region_chunk_info info;
-	region_file file;
-
-	// open file at path
-	file = region_file(path);
-	fill_count = 0;
 
 	// assign attribute values
 	for(unsigned int i = 0; i < region_file::REGION_SIZE; ++i)
 		for(unsigned int j = 0; j < region_file::REGION_SIZE; ++j) {
 			pos = i * region_file::REGION_SIZE + j;
-			file.get_chunk_info(j, i, info);
-			if(!info.get_position())
-				continue;
-			//file.get_chunk_tag(j, i, data[pos]);
-			fill[pos] = true;
-			fill_count++;
+			fill[pos] = file.is_filled(j, i);
+			if(fill[pos])
+				fill_count++;
 		}
 }
 
@@ -90,6 +81,7 @@ region_file_reader &region_file_reader::operator=(const region_file_reader &othe
 		return *this;
 
 	// assign all attributes
+	file = other.file;
 	fill_count = other.fill_count;
 	path = other.path;
 	for(unsigned int i = 0; i < region_file::CHUNK_COUNT; ++i) {
@@ -123,10 +115,10 @@ bool region_file_reader::operator==(const region_file_reader &other) {
  * Returns a chunk tag blocks array at a given x, z coord
  */
 bool region_file_reader::get_chunk_blocks_at(unsigned int x, unsigned int z, std::vector<int8_t> &value) {
-	byte_array_tag *tag = get_chunk_value_at<byte_array_tag>(x, z, TAGS[BLOCKS]);
+	byte_array_tag *tag = get_chunk_value_at<byte_array_tag>(x, z, BLOCKS);
 	if(!tag)
 		return false;
-	value = tag->value;
+	value.assign(tag->value.begin(), tag->value.end());
 	return true;
 }
 
@@ -134,10 +126,10 @@ bool region_file_reader::get_chunk_blocks_at(unsigned int x, unsigned int z, std
  * Returns a chunk tag height array at a given x, z coord
  */
 bool region_file_reader::get_chunk_heights_at(unsigned int x, unsigned int z, std::vector<int8_t> &value) {
-	byte_array_tag *tag = get_chunk_value_at<byte_array_tag>(x, z, TAGS[HEIGHTS]);
+	byte_array_tag *tag = get_chunk_value_at<byte_array_tag>(x, z, HEIGHTS);
 	if(!tag)
 		return false;
-	value = tag->value;
+	value.assign(tag->value.begin(), tag->value.end());
 	return true;
 }
 
@@ -145,7 +137,7 @@ bool region_file_reader::get_chunk_heights_at(unsigned int x, unsigned int z, st
  * Returns a chunk tag x position at a given x, z coord
  */
 bool region_file_reader::get_chunk_x_pos_at(unsigned int x, unsigned int z, int32_t &value) {
-	int_tag *tag = get_chunk_value_at<int_tag>(x, z, TAGS[XPOS]);
+	int_tag *tag = get_chunk_value_at<int_tag>(x, z, XPOS);
 	if(!tag)
 		return false;
 	value = tag->value;
@@ -156,7 +148,7 @@ bool region_file_reader::get_chunk_x_pos_at(unsigned int x, unsigned int z, int3
  * Returns a chunk tag z position at a given x, z coord
  */
 bool region_file_reader::get_chunk_z_pos_at(unsigned int x, unsigned int z, int32_t &value) {
-	int_tag *tag = get_chunk_value_at<int_tag>(x, z, TAGS[ZPOS]);
+	int_tag *tag = get_chunk_value_at<int_tag>(x, z, ZPOS);
 	if(!tag)
 		return false;
 	value = tag->value;
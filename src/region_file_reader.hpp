@@ -20,6 +20,7 @@
 #ifndef REGION_FILE_READER_HPP_
 #define REGION_FILE_READER_HPP_
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -45,6 +46,12 @@ private:
 	 */
 	bool fill[region_file::CHUNK_COUNT];
 
+	/*
+	 * Region file
+	 * (kept open across cache-misses)
+	 */
+	region_file file;
+
 	/*
 	 * Region file path
 	 */
@@ -52,16 +59,24 @@ private:
 
 	/*
 	 * Supported tags
+	 * (paths below the chunks root tag)
 	 */
 	enum TAG_NAME { BLOCKS, HEIGHTS, XPOS, ZPOS, };
 	static const std::string TAGS[];
 	static const unsigned int TAG_COUNT = 4;
 
+	/*
+	 * Supported tag paths
+	 * (pooled name ids, parsed once their names are pooled)
+	 */
+	std::vector<uint32_t> tag_paths[TAG_COUNT];
+
 	/*
 	 * Returns a chunk tag value at a given x, z coord
+	 * (looked up by path, see region_chunk_tag::get_tag_by_path)
 	 */
 	template <class T>
-	T *get_chunk_value_at(unsigned int x, unsigned int z, const std::string &name) {
+	T *get_chunk_value_at(unsigned int x, unsigned int z, unsigned int tag) {
 		unsigned int pos = z * region_file::REGION_SIZE + x;
 
 		// check if x, z coord are out-of-bounds
@@ -73,11 +88,15 @@ private:
 
 		// cache tag data if cache-miss occurs
 		if(fill[pos]
-		        && data[pos].empty()) {
-			region_file file(path);
+		        && data[pos].empty())
 			file.get_chunk_tag(x, z, data[pos]);
-		}
-		return dynamic_cast<T *>(data[pos].get_tag_by_name(name));
+
+		// parse tag path (names missing from the pool are parsed again)
+		std::vector<uint32_t> &path = tag_paths[tag];
+		if(path.empty()
+				|| std::find(path.begin(), path.end(), tag_name_pool::NONE) != path.end())
+			region_chunk_tag::parse_path(TAGS[tag], path);
+		return dynamic_cast<T *>(data[pos].get_tag_by_path(path));
 	}
 
 public:
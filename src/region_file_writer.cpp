@@ -0,0 +1,316 @@
+/*
+ * region_file_writer.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "byte_order.hpp"
+#include "region_file_exc.hpp"
+#include "region_file_writer.hpp"
+
+/*
+ * Region file writer constructor
+ */
+region_file_writer::region_file_writer(const std::string &path) : fd(-1), dirty(false), level(Z_DEFAULT_COMPRESSION), path(path) {
+	struct stat st;
+	uint32_t loc;
+
+	// open or create file at path
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if(fd < 0)
+		throw region_file_exc(region_file_exc::INVALID_PATH, path);
+	if(fstat(fd, &st)) {
+		::close(fd);
+		throw region_file_exc(region_file_exc::INVALID_PATH, path);
+	}
+
+	// read header (new files start empty)
+	memset(header, 0, region_file::HEADER_SIZE);
+	if(!st.st_size)
+		dirty = true;
+	else if(st.st_size < (off_t) region_file::HEADER_SIZE
+			|| pread(fd, header, region_file::HEADER_SIZE, 0) != region_file::HEADER_SIZE) {
+		::close(fd);
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, path);
+	}
+
+	// build sector bitmap from the location table
+	used.assign((st.st_size + region_file::SECTOR_SIZE - 1) / region_file::SECTOR_SIZE, false);
+	mark(0, region_file::HEADER_SIZE / region_file::SECTOR_SIZE, true);
+	for(unsigned int i = 0; i < region_file::CHUNK_COUNT; ++i) {
+		loc = byte_order::load<uint32_t>(header + i * sizeof(int32_t), false);
+		if(loc)
+			mark(loc >> 8, loc & 0xff, true);
+	}
+}
+
+/*
+ * Region file writer destructor
+ */
+region_file_writer::~region_file_writer(void) {
+
+	// flush header, errors cannot be reported here
+	try {
+		flush();
+	} catch(...) {
+		;
+	}
+	::close(fd);
+}
+
+/*
+ * Finds a run of free sectors
+ */
+unsigned int region_file_writer::allocate(unsigned int count) {
+	unsigned int run = 0;
+
+	// reuse the first free run that fits
+	for(unsigned int i = 0; i < used.size(); ++i) {
+		run = used[i] ? 0 : run + 1;
+		if(run == count)
+			return i + 1 - count;
+	}
+
+	// append, extending any free run at the end of the file
+	return used.size() - run;
+}
+
+/*
+ * Compresses data for a given compression type into comp_buff
+ * (after room for the chunk header)
+ */
+void region_file_writer::compress(unsigned int type, const int8_t *data, uint64_t len) {
+	int ret;
+	uLong bound;
+	z_stream str;
+
+	comp_buff.resize(region_file::CHUNK_HEADER_SIZE);
+	switch(type) {
+		case region_chunk_info::UNCOMPRESSED:
+			comp_buff.insert(comp_buff.end(), data, data + len);
+			break;
+		case region_chunk_info::GZIP:
+		case region_chunk_info::ZLIB:
+
+			// setup zlib object (gzip headers for GZIP)
+			memset(&str, 0, sizeof(str));
+			if(deflateInit2(&str, level, Z_DEFLATED, type == region_chunk_info::GZIP ? 16 + MAX_WBITS : MAX_WBITS,
+					8, Z_DEFAULT_STRATEGY) != Z_OK)
+				throw region_file_exc(region_file_exc::COMPRESS_FAIL, "deflateInit2");
+
+			// deflate in a single pass into a worst-case sized buffer
+			bound = deflateBound(&str, len);
+			comp_buff.resize(region_file::CHUNK_HEADER_SIZE + bound);
+			str.next_in = (Bytef *) data;
+			str.avail_in = len;
+			str.next_out = (Bytef *) comp_buff.data() + region_file::CHUNK_HEADER_SIZE;
+			str.avail_out = bound;
+			ret = deflate(&str, Z_FINISH);
+			comp_buff.resize(region_file::CHUNK_HEADER_SIZE + str.total_out);
+			deflateEnd(&str);
+			if(ret != Z_STREAM_END)
+				throw region_file_exc(region_file_exc::COMPRESS_FAIL, ret);
+			break;
+		default: throw region_file_exc(region_file_exc::UNSUPPORTED_COMPRESSION, type);
+			break;
+	}
+}
+
+/*
+ * Writes the header if chunks changed, then allows freed sectors to be reused
+ */
+void region_file_writer::flush(void) {
+
+	// location & timestamp tables in a single write
+	if(dirty) {
+		write_file(header, region_file::HEADER_SIZE, 0);
+		dirty = false;
+	}
+
+	// sectors released before this header are now free
+	for(unsigned int i = 0; i < released.size(); ++i)
+		mark(released.at(i).first, released.at(i).second, false);
+	released.clear();
+}
+
+/*
+ * Returns the header location entry for a given x, z coord
+ */
+uint32_t region_file_writer::get_location(unsigned int x, unsigned int z) {
+
+	// check if x, z coord are out-of-bounds
+	if(x + z * region_file::REGION_SIZE >= region_file::CHUNK_COUNT) {
+		unsigned int coord[] = {x, z};
+		std::vector<unsigned int> coord_vec(coord, coord + 2);
+		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, coord_vec);
+	}
+	return byte_order::load<uint32_t>(header + (x + z * region_file::REGION_SIZE) * sizeof(int32_t), false);
+}
+
+/*
+ * Returns the number of free sectors below the end of the file
+ */
+unsigned int region_file_writer::get_free_sectors(void) {
+	unsigned int count = 0;
+
+	for(unsigned int i = 0; i < used.size(); ++i)
+		if(!used[i])
+			++count;
+	return count;
+}
+
+/*
+ * Marks a run of sectors used/free
+ */
+void region_file_writer::mark(unsigned int sector, unsigned int count, bool value) {
+	if(sector + count > used.size())
+		used.resize(sector + count, false);
+	for(unsigned int i = sector; i < sector + count; ++i)
+		used[i] = value;
+}
+
+/*
+ * Places the chunk in comp_buff into free sectors & updates its header entries
+ */
+void region_file_writer::place(unsigned int x, unsigned int z, unsigned int type, time_t modified) {
+	unsigned int count, pos = x + z * region_file::REGION_SIZE, sector;
+	uint64_t size = comp_buff.size();
+
+	// fill in chunk header
+	byte_order::store<uint32_t>(comp_buff.data(), size - sizeof(int32_t), false);
+	comp_buff[sizeof(int32_t)] = type;
+
+	// pad to whole sectors (at most 255 per chunk)
+	count = (size + region_file::SECTOR_SIZE - 1) / region_file::SECTOR_SIZE;
+	if(count > 0xff)
+		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, size);
+	comp_buff.resize((uint64_t) count * region_file::SECTOR_SIZE, 0);
+
+	// release the old copy (reusable after the next flush) & place the new one
+	release(x, z);
+	sector = allocate(count);
+	if(sector >= (1U << 24))
+		throw region_file_exc(region_file_exc::OUT_OF_BOUNDS, sector);
+	write_file(comp_buff.data(), comp_buff.size(), (uint64_t) sector * region_file::SECTOR_SIZE);
+	mark(sector, count, true);
+
+	// update location & timestamp entries
+	byte_order::store<uint32_t>(header + pos * sizeof(int32_t), (sector << 8) | count, false);
+	byte_order::store<uint32_t>(header + (region_file::CHUNK_COUNT + pos) * sizeof(int32_t), modified, false);
+	dirty = true;
+}
+
+/*
+ * Releases a chunks sectors & clears its header entries
+ */
+void region_file_writer::release(unsigned int x, unsigned int z) {
+	unsigned int pos = x + z * region_file::REGION_SIZE;
+	uint32_t loc = get_location(x, z);
+
+	// check if chunk is empty
+	if(!loc)
+		return;
+	released.push_back(std::make_pair(loc >> 8, loc & 0xff));
+	byte_order::store<uint32_t>(header + pos * sizeof(int32_t), 0, false);
+	byte_order::store<uint32_t>(header + (region_file::CHUNK_COUNT + pos) * sizeof(int32_t), 0, false);
+	dirty = true;
+}
+
+/*
+ * Removes a chunk at a given x, z coord
+ */
+void region_file_writer::remove_chunk(unsigned int x, unsigned int z) {
+	release(x, z);
+}
+
+/*
+ * Returns a string representation of a region file writer
+ */
+std::string region_file_writer::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[REGION WRITER] " << path << ", sectors: " << used.size() << ", free: " << get_free_sectors();
+	if(dirty)
+		ss << " (DIRTY)";
+	return ss.str();
+}
+
+/*
+ * Writes a chunk tag at a given x, z coord
+ */
+void region_file_writer::write_chunk(unsigned int x, unsigned int z, region_chunk_tag &tag, unsigned int type) {
+
+	// serialize into the reusable stream (fails on tags that cannot be written,
+	// e.g. strings longer than byte_stream_writer::MAX_STRING_LENGTH)
+	stream.clear();
+	if(!tag.write(stream)) {
+		unsigned int coord[] = {x, z};
+		std::vector<unsigned int> coord_vec(coord, coord + 2);
+		throw region_file_exc(region_file_exc::STREAM_WRITE_ERROR, coord_vec);
+	}
+	write_chunk_data(x, z, stream.rdbuf(), stream.size(), type);
+}
+
+/*
+ * Writes serialized chunk data at a given x, z coord
+ */
+void region_file_writer::write_chunk_data(unsigned int x, unsigned int z, const int8_t *data, uint64_t len, unsigned int type) {
+
+	// compress behind the chunk header
+	get_location(x, z);
+	compress(type, data, len);
+	place(x, z, type, time(NULL));
+}
+
+/*
+ * Writes an already compressed chunk payload at a given x, z coord
+ */
+void region_file_writer::write_chunk_payload(unsigned int x, unsigned int z, unsigned int type, const int8_t *data, uint64_t len, time_t modified) {
+
+	// copy behind the chunk header
+	get_location(x, z);
+	comp_buff.resize(region_file::CHUNK_HEADER_SIZE);
+	comp_buff.insert(comp_buff.end(), data, data + len);
+	place(x, z, type, modified);
+}
+
+/*
+ * Writes len bytes at a given file offset
+ */
+void region_file_writer::write_file(const int8_t *data, uint64_t len, uint64_t offset) {
+	ssize_t count;
+
+	while(len) {
+		count = pwrite(fd, data, len, offset);
+		if(count < 0
+				&& errno == EINTR)
+			continue;
+		if(count <= 0)
+			throw region_file_exc(region_file_exc::STREAM_WRITE_ERROR, offset);
+		data += count;
+		len -= count;
+		offset += count;
+	}
+}
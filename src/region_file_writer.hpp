@@ -0,0 +1,196 @@
+/*
+ * region_file_writer.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGION_FILE_WRITER_HPP_
+#define REGION_FILE_WRITER_HPP_
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "byte_stream_writer.hpp"
+#include "region_chunk_info.hpp"
+#include "region_chunk_tag.hpp"
+#include "region_file.hpp"
+
+class region_file_writer {
+private:
+
+	/*
+	 * Region file descriptor
+	 */
+	int fd;
+
+	/*
+	 * Region file header (chunk locations & timestamps, big-endian)
+	 */
+	int8_t header[region_file::HEADER_SIZE];
+
+	/*
+	 * Header changed since the last flush
+	 */
+	bool dirty;
+
+	/*
+	 * Compression level
+	 */
+	int level;
+
+	/*
+	 * Sector usage bitmap (one bit per sector, header sectors included)
+	 */
+	std::vector<bool> used;
+
+	/*
+	 * Sectors released since the last flush
+	 * (still referenced by the on-disk header, so not yet reusable)
+	 */
+	std::vector<std::pair<unsigned int, unsigned int> > released;
+
+	/*
+	 * Reusable chunk serialization & compression buffers
+	 */
+	byte_stream_writer stream;
+	std::vector<int8_t> comp_buff;
+
+	/*
+	 * Region file path
+	 */
+	std::string path;
+
+	/*
+	 * Region file writer constructor
+	 * (writers own a descriptor and are not copyable)
+	 */
+	region_file_writer(const region_file_writer &other);
+
+	/*
+	 * Region file writer assignment
+	 */
+	region_file_writer &operator=(const region_file_writer &other);
+
+	/*
+	 * Finds a run of free sectors (first fit, appending when none fits)
+	 */
+	unsigned int allocate(unsigned int count);
+
+	/*
+	 * Compresses data for a given compression type into comp_buff
+	 */
+	void compress(unsigned int type, const int8_t *data, uint64_t len);
+
+	/*
+	 * Returns the header location entry for a given x, z coord
+	 */
+	uint32_t get_location(unsigned int x, unsigned int z);
+
+	/*
+	 * Marks a run of sectors used/free
+	 */
+	void mark(unsigned int sector, unsigned int count, bool value);
+
+	/*
+	 * Places the chunk in comp_buff into free sectors & updates its header entries
+	 */
+	void place(unsigned int x, unsigned int z, unsigned int type, time_t modified);
+
+	/*
+	 * Releases a chunks sectors & clears its header entries
+	 */
+	void release(unsigned int x, unsigned int z);
+
+	/*
+	 * Writes len bytes at a given file offset
+	 */
+	void write_file(const int8_t *data, uint64_t len, uint64_t offset);
+
+public:
+
+	/*
+	 * Region file writer constructor
+	 * (opens or creates the region file at path)
+	 */
+	region_file_writer(const std::string &path);
+
+	/*
+	 * Region file writer destructor
+	 * (flushes the header)
+	 */
+	virtual ~region_file_writer(void);
+
+	/*
+	 * Writes the header if chunks changed, then allows freed sectors to be reused
+	 */
+	void flush(void);
+
+	/*
+	 * Returns the compression level
+	 */
+	int get_level(void) { return level; }
+
+	/*
+	 * Returns region file path
+	 */
+	std::string get_path(void) { return path; }
+
+	/*
+	 * Returns the number of free sectors below the end of the file
+	 */
+	unsigned int get_free_sectors(void);
+
+	/*
+	 * Returns the number of sectors in the file
+	 */
+	unsigned int get_sectors(void) { return used.size(); }
+
+	/*
+	 * Removes a chunk at a given x, z coord
+	 */
+	void remove_chunk(unsigned int x, unsigned int z);
+
+	/*
+	 * Sets the compression level (zlib levels, 0-9)
+	 */
+	void set_level(int level) { this->level = level; }
+
+	/*
+	 * Returns a string representation of a region file writer
+	 */
+	std::string to_string(void);
+
+	/*
+	 * Writes a chunk tag at a given x, z coord
+	 * (GZIP, ZLIB or UNCOMPRESSED)
+	 */
+	void write_chunk(unsigned int x, unsigned int z, region_chunk_tag &tag, unsigned int type = region_chunk_info::ZLIB);
+
+	/*
+	 * Writes serialized chunk data at a given x, z coord
+	 * (GZIP, ZLIB or UNCOMPRESSED)
+	 */
+	void write_chunk_data(unsigned int x, unsigned int z, const int8_t *data, uint64_t len, unsigned int type = region_chunk_info::ZLIB);
+
+	/*
+	 * Writes an already compressed chunk payload at a given x, z coord
+	 * (copied as-is, keeping its compression type & timestamp)
+	 */
+	void write_chunk_payload(unsigned int x, unsigned int z, unsigned int type, const int8_t *data, uint64_t len, time_t modified);
+};
+
+#endif
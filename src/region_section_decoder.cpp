@@ -0,0 +1,225 @@
+/*
+ * region_section_decoder.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "region_file.hpp"
+#include "region_file_exc.hpp"
+#include "region_section_decoder.hpp"
+
+/*
+ * Decoded tags
+ */
+const std::string region_section_decoder::TAGS[TAG_COUNT] = {
+		"Level",
+		"Sections",
+		"Y",
+		"Blocks",
+		"Add",
+		"Data",
+};
+
+/*
+ * Decodes the sections of an anvil chunk into dense block id & block data arrays
+ */
+unsigned int region_section_decoder::decode(const int8_t *in, uint64_t len, std::vector<uint16_t> &blocks, std::vector<int8_t> &data) {
+	int8_t type;
+	int16_t name_len;
+	int32_t count;
+	unsigned int mask = 0;
+	const int8_t *name = NULL;
+
+	// setup stream as a view over data (no copy)
+	byte_stream stream(const_cast<int8_t *>(in), len);
+	stream << byte_stream::NO_SWAP_ENDIAN;
+	blocks.assign(CHUNK_VOLUME, 0);
+	data.assign(CHUNK_VOLUME, 0);
+
+	// check for a root compound
+	if(!(stream >> type)
+			|| type != generic_tag::COMPOUND)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+	read_tag_name(stream, name, name_len);
+
+	// walk down to the section list, skipping everything else
+	if(!find_tag(stream, LEVEL, generic_tag::COMPOUND)
+			|| !find_tag(stream, SECTIONS, generic_tag::LIST))
+		return mask;
+	if(!(stream >> type)
+			|| !(stream >> count))
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+	if(type != generic_tag::COMPOUND)
+		return mask;
+	for(int32_t i = 0; i < count; ++i)
+		mask |= read_section(stream, blocks.data(), data.data());
+	return mask;
+}
+
+/*
+ * Expands a sections block ids & add nibbles into 16-bit block ids
+ */
+void region_section_decoder::expand_blocks(const int8_t *blocks, const int8_t *add, uint16_t *out) {
+	unsigned int i = 0;
+
+#ifdef __SSE2__
+	__m128i mask = _mm_set1_epi8(0x0f), nib, low, high, first, second;
+
+	// widen 32 blocks at a time, pairing each id byte with its add nibble
+	for(; i + 32 <= SECTION_VOLUME; i += 32) {
+		nib = add ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(add + i / 2)) : _mm_setzero_si128();
+		low = _mm_and_si128(nib, mask);
+		high = _mm_and_si128(_mm_srli_epi16(nib, 4), mask);
+		first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + i));
+		second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + i + 16));
+
+		// even blocks take the low nibble, odd blocks the high nibble
+		nib = _mm_unpacklo_epi8(low, high);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi8(first, nib));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8), _mm_unpackhi_epi8(first, nib));
+		nib = _mm_unpackhi_epi8(low, high);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 16), _mm_unpacklo_epi8(second, nib));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 24), _mm_unpackhi_epi8(second, nib));
+	}
+#endif
+
+	// widen remaining blocks
+	for(; i < SECTION_VOLUME; ++i) {
+		out[i] = (uint8_t) blocks[i];
+		if(add)
+			out[i] |= ((add[i / 2] >> ((i & 1) * 4)) & 0x0f) << 8;
+	}
+}
+
+/*
+ * Expands a sections packed nibbles into one byte per block
+ */
+void region_section_decoder::expand_nibbles(const int8_t *nibbles, int8_t *out) {
+	unsigned int i = 0;
+
+#ifdef __SSE2__
+	__m128i mask = _mm_set1_epi8(0x0f), nib, low, high;
+
+	// split 16 bytes into 32 nibbles at a time
+	for(; i + 32 <= SECTION_VOLUME; i += 32) {
+		nib = _mm_loadu_si128(reinterpret_cast<const __m128i *>(nibbles + i / 2));
+		low = _mm_and_si128(nib, mask);
+		high = _mm_and_si128(_mm_srli_epi16(nib, 4), mask);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi8(low, high));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 16), _mm_unpackhi_epi8(low, high));
+	}
+#endif
+
+	// split remaining nibbles
+	for(; i < SECTION_VOLUME; ++i)
+		out[i] = (nibbles[i / 2] >> ((i & 1) * 4)) & 0x0f;
+}
+
+/*
+ * Advances stream to a named tag of a given type within a compound
+ */
+bool region_section_decoder::find_tag(byte_stream &stream, unsigned int name, int8_t type) {
+	int8_t ele_type;
+	int16_t name_len;
+	const int8_t *ele_name = NULL;
+
+	for(;;) {
+		if(!(stream >> ele_type))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+		if(ele_type == generic_tag::END)
+			return false;
+		read_tag_name(stream, ele_name, name_len);
+
+		// compare names in place
+		if(ele_type == type
+				&& (unsigned int) name_len == TAGS[name].length()
+				&& !memcmp(ele_name, TAGS[name].data(), name_len))
+			return true;
+		region_file::skip_tag(ele_type, stream);
+	}
+}
+
+/*
+ * Decodes a single section compound into the chunk arrays
+ */
+unsigned int region_section_decoder::read_section(byte_stream &stream, uint16_t *blocks, int8_t *data) {
+	int8_t ele_type, y = -1;
+	int16_t name_len;
+	int32_t arr_len;
+	unsigned int tag;
+	const int8_t *name = NULL, *arr[TAG_COUNT] = {NULL};
+
+	// collect section arrays in place (Y may follow them)
+	for(;;) {
+		if(!(stream >> ele_type))
+			throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+		if(ele_type == generic_tag::END)
+			break;
+		read_tag_name(stream, name, name_len);
+		for(tag = Y; tag < TAG_COUNT; ++tag)
+			if((unsigned int) name_len == TAGS[tag].length()
+					&& !memcmp(name, TAGS[tag].data(), name_len))
+				break;
+
+		// read section height
+		if(tag == Y
+				&& ele_type == generic_tag::BYTE) {
+			if(!(stream >> y))
+				throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+			continue;
+		}
+
+		// reference block arrays (ids are one byte per block, add/data one nibble)
+		if(tag >= BLOCKS
+				&& tag < TAG_COUNT
+				&& ele_type == generic_tag::BYTE_ARRAY) {
+			if(!(stream >> arr_len)
+					|| (uint32_t) arr_len != (tag == BLOCKS ? SECTION_VOLUME : SECTION_VOLUME / 2))
+				throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+			arr[tag] = stream.rdbuf() + stream.position();
+			if(!stream.skip(arr_len))
+				throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+			continue;
+		}
+		region_file::skip_tag(ele_type, stream);
+	}
+
+	// sections without blocks or outside the chunk are ignored
+	if(y < 0
+			|| y >= (int8_t) SECTION_COUNT
+			|| !arr[BLOCKS])
+		return 0;
+	expand_blocks(arr[BLOCKS], arr[ADD], blocks + y * SECTION_VOLUME);
+	if(arr[DATA])
+		expand_nibbles(arr[DATA], data + y * SECTION_VOLUME);
+	return 1 << y;
+}
+
+/*
+ * Reads a tag name from stream, returning a pointer to it in place
+ */
+void region_section_decoder::read_tag_name(byte_stream &stream, const int8_t *&name, int16_t &len) {
+	if(!(stream >> len)
+			|| len < 0)
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+	name = stream.rdbuf() + stream.position();
+	if(!stream.skip(len))
+		throw region_file_exc(region_file_exc::STREAM_READ_ERROR, stream.position());
+}
@@ -0,0 +1,83 @@
+/*
+ * region_section_decoder.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGION_SECTION_DECODER_HPP_
+#define REGION_SECTION_DECODER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "byte_stream.hpp"
+
+class region_section_decoder {
+private:
+
+	/*
+	 * Decoded tags
+	 */
+	enum TAG_NAME { LEVEL, SECTIONS, Y, BLOCKS, ADD, DATA, };
+	static const std::string TAGS[];
+	static const unsigned int TAG_COUNT = 6;
+
+	/*
+	 * Expands a sections block ids & add nibbles into 16-bit block ids
+	 * (add may be NULL)
+	 */
+	static void expand_blocks(const int8_t *blocks, const int8_t *add, uint16_t *out);
+
+	/*
+	 * Expands a sections packed nibbles into one byte per block
+	 */
+	static void expand_nibbles(const int8_t *nibbles, int8_t *out);
+
+	/*
+	 * Advances stream to a named tag of a given type within a compound
+	 * (returns false once the compound ends)
+	 */
+	static bool find_tag(byte_stream &stream, unsigned int name, int8_t type);
+
+	/*
+	 * Decodes a single section compound into the chunk arrays
+	 * (returns the sections bit in the section mask)
+	 */
+	static unsigned int read_section(byte_stream &stream, uint16_t *blocks, int8_t *data);
+
+	/*
+	 * Reads a tag name from stream, returning a pointer to it in place
+	 */
+	static void read_tag_name(byte_stream &stream, const int8_t *&name, int16_t &len);
+
+public:
+
+	/*
+	 * Chunk dimensions
+	 */
+	static const unsigned int SECTION_COUNT = 16;
+	static const unsigned int SECTION_VOLUME = 4096;
+	static const unsigned int CHUNK_VOLUME = SECTION_COUNT * SECTION_VOLUME;
+
+	/*
+	 * Decodes the sections of an anvil chunk into dense block id & block data arrays
+	 * (in is uncompressed chunk data, blocks & data are replaced with CHUNK_VOLUME entries
+	 * in YZX order, and a mask of the sections present is returned)
+	 */
+	static unsigned int decode(const int8_t *in, uint64_t len, std::vector<uint16_t> &blocks, std::vector<int8_t> &data);
+};
+
+#endif
@@ -71,8 +71,8 @@ std::string byte_array_tag::to_string(void) {
 
 	// create string representation
 	ss << generic_tag::type_to_string(type);
-	if(!name.empty())
-		ss << " " << name;
+	if(name != tag_name_pool::EMPTY)
+		ss << " " << get_name();
 	ss << " (" << value.size() << ")";
 	if(!value.empty()) {
 		ss << " { ";
@@ -30,7 +30,7 @@ public:
 	/*
 	 * Byte array tag value
 	 */
-	std::vector<int8_t> value;
+	std::vector<int8_t, tag_allocator<int8_t> > value;
 
 	/*
 	 * Byte array tag constructor
@@ -40,17 +40,23 @@ public:
 	/*
 	 * Byte array tag constructor
 	 */
-	byte_array_tag(const byte_array_tag &other) : generic_tag(other.name, BYTE_ARRAY), value(other.value) { return; }
+	byte_array_tag(const byte_array_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * Byte array tag constructor
 	 */
-	byte_array_tag(std::vector<int8_t> value) : generic_tag(BYTE_ARRAY), value(value) { return; }
+	byte_array_tag(std::vector<int8_t> value) : generic_tag(BYTE_ARRAY), value(value.begin(), value.end()) { return; }
 
 	/*
 	 * Byte array tag constructor
 	 */
-	byte_array_tag(const std::string &name, std::vector<int8_t> &value) : generic_tag(name, BYTE_ARRAY), value(value) { return; }
+	byte_array_tag(const std::string &name, std::vector<int8_t> &value) : generic_tag(name, BYTE_ARRAY), value(value.begin(), value.end()) { return; }
+
+	/*
+	 * Byte array tag constructor
+	 * (empty, name is a pooled name id, allocated from arena, if any)
+	 */
+	byte_array_tag(uint32_t name, tag_arena *arena) : generic_tag(name, BYTE_ARRAY, arena), value(tag_allocator<int8_t>(arena)) { return; }
 
 	/*
 	 * Byte array tag destructor
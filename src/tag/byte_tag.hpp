@@ -39,7 +39,7 @@ public:
 	/*
 	 * Byte tag constructor
 	 */
-	byte_tag(const byte_tag &other) : generic_tag(other.name, BYTE), value(other.value) { return; }
+	byte_tag(const byte_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * Byte tag constructor
@@ -51,6 +51,12 @@ public:
 	 */
 	byte_tag(const std::string &name, int8_t value) : generic_tag(name, BYTE), value(value) { return; }
 
+	/*
+	 * Byte tag constructor
+	 * (name is a pooled name id, allocated from arena, if any)
+	 */
+	byte_tag(uint32_t name, int8_t value, tag_arena *arena) : generic_tag(name, BYTE, arena), value(value) { return; }
+
 	/*
 	 * Byte tag destructor
 	 */
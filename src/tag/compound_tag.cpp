@@ -25,6 +25,7 @@
 #include "end_tag.hpp"
 #include "float_tag.hpp"
 #include "generic_tag.hpp"
+#include "int_array_tag.hpp"
 #include "int_tag.hpp"
 #include "list_tag.hpp"
 #include "long_tag.hpp"
@@ -43,6 +44,8 @@ compound_tag &compound_tag::operator=(const compound_tag &other) {
 	// set attributes
 	generic_tag::operator =(other);
 	value.assign(other.value.begin(), other.value.end());
+	index.clear();
+	indexed = 0;
 	return *this;
 }
 
@@ -75,6 +78,10 @@ bool compound_tag::operator==(const compound_tag &other) {
 				if(*static_cast<byte_array_tag *>(value.at(i)) != *static_cast<byte_array_tag *>(other.value.at(i)))
 					return false;
 				break;
+			case generic_tag::INT_ARRAY:
+				if(*static_cast<int_array_tag *>(value.at(i)) != *static_cast<int_array_tag *>(other.value.at(i)))
+					return false;
+				break;
 			case generic_tag::BYTE:
 				if(*static_cast<byte_tag *>(value.at(i)) != *static_cast<byte_tag *>(other.value.at(i)))
 					return false;
@@ -124,6 +131,68 @@ generic_tag *compound_tag::at(unsigned int index) {
 	return value.at(index);
 }
 
+/*
+ * Returns the first child with a given pooled name id
+ */
+generic_tag *compound_tag::find(uint32_t name) {
+	uint32_t slot, mask;
+
+	// small compounds are scanned directly
+	if(value.size() < INDEX_THRESHOLD) {
+		for(unsigned int i = 0; i < value.size(); ++i)
+			if(value[i]->has_name(name))
+				return value[i];
+		return NULL;
+	}
+
+	// build index on first use (or once children were added/removed)
+	if(indexed != value.size()
+			|| index.empty())
+		reindex();
+
+	// name ids are dense, so they are used as their own hash
+	mask = index.size() - 1;
+	for(slot = name & mask; index[slot]; slot = (slot + 1) & mask)
+		if(value[index[slot] - 1]->has_name(name))
+			return value[index[slot] - 1];
+	return NULL;
+}
+
+/*
+ * Returns the first child with a given name
+ */
+generic_tag *compound_tag::find(const std::string &name) {
+	uint32_t id = tag_name_pool::find(name);
+
+	// names never pooled match no child
+	if(id == tag_name_pool::NONE)
+		return NULL;
+	return find(id);
+}
+
+/*
+ * Rebuilds the child index
+ */
+void compound_tag::reindex(void) {
+	uint32_t slot, mask, capacity = INDEX_THRESHOLD * 2;
+
+	// keep the index under half full
+	while(capacity < value.size() * 2)
+		capacity *= 2;
+	index.assign(capacity, 0);
+	mask = capacity - 1;
+
+	// index each name at its first child
+	for(unsigned int i = 0; i < value.size(); ++i) {
+		for(slot = value[i]->get_name_id() & mask; index[slot]; slot = (slot + 1) & mask)
+			if(value[index[slot] - 1]->has_name(value[i]->get_name_id()))
+				break;
+		if(!index[slot])
+			index[slot] = i + 1;
+	}
+	indexed = value.size();
+}
+
 /*
  * Returns a string representation of a compound tag
  */
@@ -132,8 +201,8 @@ std::string compound_tag::to_string(void) {
 
 	// create string representation
 	ss << generic_tag::type_to_string(type);
-	if(!name.empty())
-		ss << " " << name;
+	if(name != tag_name_pool::EMPTY)
+		ss << " " << get_name();
 	ss << " (" << value.size() << ")";
 	if(!value.empty()) {
 		ss << " {" << std::endl;
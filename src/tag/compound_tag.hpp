@@ -24,32 +24,59 @@
 #include "generic_tag.hpp"
 
 class compound_tag : public generic_tag {
+private:
+
+	/*
+	 * Child index
+	 * (child positions + 1 by name id, open addressing, 0 marks an unused slot)
+	 */
+	std::vector<uint32_t, tag_allocator<uint32_t> > index;
+
+	/*
+	 * Child count when the index was built
+	 */
+	uint32_t indexed;
+
 public:
 
+	/*
+	 * Child count from which lookups are indexed
+	 * (smaller compounds are scanned directly)
+	 */
+	static const unsigned int INDEX_THRESHOLD = 8;
+
 	/*
 	 * Compound tag value
+	 * (call reindex after replacing children in place)
 	 */
-	std::vector<generic_tag *> value;
+	std::vector<generic_tag *, tag_allocator<generic_tag *> > value;
 
 	/*
 	 * Compound tag constructor
 	 */
-	compound_tag(void) : generic_tag(COMPOUND) { return; }
+	compound_tag(void) : generic_tag(COMPOUND), indexed(0) { return; }
 
 	/*
 	 * Compound tag constructor
 	 */
-	compound_tag(const compound_tag &other) : generic_tag(other.name, COMPOUND), value(other.value) { return; }
+	compound_tag(const compound_tag &other) : generic_tag(other), indexed(0), value(other.value) { return; }
 
 	/*
 	 * Compound tag constructor
 	 */
-	compound_tag(std::vector<generic_tag *> value) : generic_tag(COMPOUND), value(value) { return; }
+	compound_tag(std::vector<generic_tag *> value) : generic_tag(COMPOUND), indexed(0), value(value.begin(), value.end()) { return; }
 
 	/*
 	 * Compound tag constructor
 	 */
-	compound_tag(const std::string &name, std::vector<generic_tag *> &value) : generic_tag(name, COMPOUND), value(value) { return; }
+	compound_tag(const std::string &name, std::vector<generic_tag *> &value) : generic_tag(name, COMPOUND), indexed(0), value(value.begin(), value.end()) { return; }
+
+	/*
+	 * Compound tag constructor
+	 * (empty, name is a pooled name id, allocated from arena, if any)
+	 */
+	compound_tag(uint32_t name, tag_arena *arena) : generic_tag(name, COMPOUND, arena), index(tag_allocator<uint32_t>(arena)), indexed(0),
+			value(tag_allocator<generic_tag *>(arena)) { return; }
 
 	/*
 	 * Compound tag destructor
@@ -86,11 +113,28 @@ public:
 	 */
 	bool empty(void) { return value.empty(); }
 
+	/*
+	 * Returns the first child with a given pooled name id
+	 * (indexed once the compound holds INDEX_THRESHOLD children)
+	 */
+	generic_tag *find(uint32_t name);
+
+	/*
+	 * Returns the first child with a given name
+	 */
+	generic_tag *find(const std::string &name);
+
 	/*
 	 * Returns a compound tag value
 	 */
 	void *get_value(void) { return &value; }
 
+	/*
+	 * Rebuilds the child index
+	 * (the index is rebuilt on its own when the child count changes)
+	 */
+	void reindex(void);
+
 	/*
 	 * Returns the size of a compound tag
 	 */
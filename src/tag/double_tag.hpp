@@ -38,7 +38,7 @@ public:
 	/*
 	 * Double tag constructor
 	 */
-	double_tag(const double_tag &other) : generic_tag(other.name, DOUBLE), value(other.value) { return; }
+	double_tag(const double_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * Double tag constructor
@@ -50,6 +50,12 @@ public:
 	 */
 	double_tag(const std::string &name, double value) : generic_tag(name, DOUBLE), value(value) { return; }
 
+	/*
+	 * Double tag constructor
+	 * (name is a pooled name id, allocated from arena, if any)
+	 */
+	double_tag(uint32_t name, double value, tag_arena *arena) : generic_tag(name, DOUBLE, arena), value(value) { return; }
+
 	/*
 	 * Double tag destructor
 	 */
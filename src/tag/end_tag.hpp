@@ -33,7 +33,13 @@ public:
 	/*
 	 * End tag constructor
 	 */
-	end_tag(const end_tag &other) : generic_tag(other.name, END) { return; }
+	end_tag(const end_tag &other) : generic_tag(other) { return; }
+
+	/*
+	 * End tag constructor
+	 * (allocated from arena, if any)
+	 */
+	end_tag(tag_arena *arena) : generic_tag(tag_name_pool::EMPTY, END, arena) { return; }
 
 	/*
 	 * End tag destructor
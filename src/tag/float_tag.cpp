@@ -57,8 +57,8 @@ std::string float_tag::to_string(void) {
 
 	// create string representation
 	ss << generic_tag::type_to_string(type);
-	if(!name.empty())
-		ss << " " << name;
+	if(name != tag_name_pool::EMPTY)
+		ss << " " << get_name();
 	ss << ": " << value;
 	return ss.str();
 }
@@ -38,7 +38,7 @@ public:
 	/*
 	 * Float tag constructor
 	 */
-	float_tag(const float_tag &other) : generic_tag(other.name, FLOAT), value(other.value) { return; }
+	float_tag(const float_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * Float tag constructor
@@ -50,6 +50,12 @@ public:
 	 */
 	float_tag(const std::string &name, float value) : generic_tag(name, FLOAT), value(value) { return; }
 
+	/*
+	 * Float tag constructor
+	 * (name is a pooled name id, allocated from arena, if any)
+	 */
+	float_tag(uint32_t name, float value, tag_arena *arena) : generic_tag(name, FLOAT, arena), value(value) { return; }
+
 	/*
 	 * Float tag destructor
 	 */
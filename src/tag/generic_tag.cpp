@@ -56,8 +56,8 @@ std::string generic_tag::to_string(void) {
 
 	// create string representation
 	out.append(type_to_string(type));
-	if(!name.empty())
-		out.append(": " + name);
+	if(name != tag_name_pool::EMPTY)
+		out.append(": ").append(get_name());
 	return out;
 }
 
@@ -89,9 +89,27 @@ std::string generic_tag::type_to_string(char type) {
 			break;
 		case COMPOUND: out.append("COMPOUND");
 			break;
+		case INT_ARRAY: out.append("INT ARRAY");
+			break;
 		default: out.append("UNKNOWN");
 			break;
 	}
 	out.append("]");
 	return out;
 }
+
+/*
+ * Returns the encoded width of a tag types value
+ */
+unsigned int generic_tag::type_width(char type) {
+	switch(type) {
+		case END: return 0;
+		case BYTE: return 1;
+		case SHORT: return 2;
+		case INT: return 4;
+		case LONG: return 8;
+		case FLOAT: return 4;
+		case DOUBLE: return 8;
+		default: return 0;
+	}
+}
\ No newline at end of file
@@ -21,44 +21,59 @@
 #define GENERIC_TAG_HPP_
 
 #include <string>
+#include "tag_arena.hpp"
+#include "tag_name_pool.hpp"
 
 class generic_tag {
 public:
 
 	/*
 	 * Tag name
+	 * (pooled name id, see tag_name_pool)
 	 */
-	std::string name;
+	uint32_t name;
 
 	/*
 	 * Tag type
 	 */
 	char type;
 
+	/*
+	 * Arena allocation
+	 * (pooled tags are freed with their arena, never deleted)
+	 */
+	bool pooled;
+
 	/*
 	 * Supported tag types
 	 */
-	enum TYPE { END, BYTE, SHORT, INT, LONG, FLOAT, DOUBLE, BYTE_ARRAY, STRING, LIST, COMPOUND };
+	enum TYPE { END, BYTE, SHORT, INT, LONG, FLOAT, DOUBLE, BYTE_ARRAY, STRING, LIST, COMPOUND, INT_ARRAY };
 
 	/*
 	 * Generic tag constructor
 	 */
-	generic_tag(void) : type(END) { return; }
+	generic_tag(void) : name(tag_name_pool::EMPTY), type(END), pooled(false) { return; }
 
 	/*
 	 * Generic tag constructor
 	 */
-	generic_tag(const generic_tag &other) : name(other.name), type(other.type) { return; }
+	generic_tag(const generic_tag &other) : name(other.name), type(other.type), pooled(false) { return; }
 
 	/*
 	 * Generic tag constructor
 	 */
-	generic_tag(char type) : type(END) { return; }
+	generic_tag(char type) : name(tag_name_pool::EMPTY), type(END), pooled(false) { return; }
 
 	/*
 	 * Generic tag constructor
 	 */
-	generic_tag(const std::string &name, char type) : name(name), type(type) { return; }
+	generic_tag(const std::string &name, char type) : name(tag_name_pool::intern(name)), type(type), pooled(false) { return; }
+
+	/*
+	 * Generic tag constructor
+	 * (name is a pooled name id, the tag is allocated from arena, if any)
+	 */
+	generic_tag(uint32_t name, char type, tag_arena *arena) : name(name), type(type), pooled(arena != NULL) { return; }
 
 	/*
 	 * Generic tag destructor
@@ -80,16 +95,58 @@ public:
 	 */
 	bool operator!=(const generic_tag &other) { return !(*this == other); }
 
+	/*
+	 * Allocates a tag from the heap
+	 */
+	static void *operator new(size_t size) { return ::operator new(size); }
+
+	/*
+	 * Allocates a tag from an arena
+	 * (from the heap without an arena)
+	 */
+	static void *operator new(size_t size, tag_arena *arena) { return arena ? arena->allocate(size) : ::operator new(size); }
+
+	/*
+	 * Frees a heap allocated tag
+	 */
+	static void operator delete(void *ptr) { ::operator delete(ptr); }
+
+	/*
+	 * Frees a tag whose construction failed
+	 */
+	static void operator delete(void *ptr, tag_arena *arena) { if(!arena) ::operator delete(ptr); }
+
 	/*
 	 * Returns a generic tags name
 	 */
-	std::string get_name(void) { return name; }
+	std::string get_name(void) { return tag_name_pool::get(name); }
+
+	/*
+	 * Returns a generic tags pooled name id
+	 */
+	uint32_t get_name_id(void) { return name; }
 
 	/*
 	 * Returns a generic tags type
 	 */
 	char get_type(void) { return type; }
 
+	/*
+	 * Returns true if a generic tag has a given name
+	 * (compared in place, no copy is made)
+	 */
+	bool has_name(const std::string &name) { return tag_name_pool::equals(this->name, name.data(), name.size()); }
+
+	/*
+	 * Returns true if a generic tag has a given pooled name id
+	 */
+	bool has_name(uint32_t name) { return this->name == name; }
+
+	/*
+	 * Returns the arena allocation status of a generic tag
+	 */
+	bool is_pooled(void) { return pooled; }
+
 	/*
 	 * Returns a generic tags value;
 	 */
@@ -104,6 +161,12 @@ public:
 	 * Returns a string representatrion of a tag type
 	 */
 	static std::string type_to_string(char type);
+
+	/*
+	 * Returns the encoded width of a tag types value
+	 * (0 for variable width types)
+	 */
+	static unsigned int type_width(char type);
 };
 
 #endif
@@ -39,7 +39,7 @@ public:
 	/*
 	 * Int tag constructor
 	 */
-	int_tag(const int_tag &other) : generic_tag(other.name, INT), value(other.value) { return; }
+	int_tag(const int_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * Int tag constructor
@@ -51,6 +51,12 @@ public:
 	 */
 	int_tag(const std::string &name, int32_t value) : generic_tag(name, INT), value(value) { return; }
 
+	/*
+	 * Int tag constructor
+	 * (name is a pooled name id, allocated from arena, if any)
+	 */
+	int_tag(uint32_t name, int32_t value, tag_arena *arena) : generic_tag(name, INT, arena), value(value) { return; }
+
 	/*
 	 * Int tag destructor
 	 */
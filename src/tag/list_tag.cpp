@@ -25,6 +25,7 @@
 #include "end_tag.hpp"
 #include "float_tag.hpp"
 #include "generic_tag.hpp"
+#include "int_array_tag.hpp"
 #include "int_tag.hpp"
 #include "list_tag.hpp"
 #include "long_tag.hpp"
@@ -42,6 +43,7 @@ list_tag &list_tag::operator=(const list_tag &other) {
 
 	// set attributes
 	generic_tag::operator =(other);
+	element = other.element;
 	value.assign(other.value.begin(), other.value.end());
 	return *this;
 }
@@ -75,6 +77,10 @@ bool list_tag::operator==(const list_tag &other) {
 				if(*static_cast<byte_array_tag *>(value.at(i)) != *static_cast<byte_array_tag *>(other.value.at(i)))
 					return false;
 				break;
+			case generic_tag::INT_ARRAY:
+				if(*static_cast<int_array_tag *>(value.at(i)) != *static_cast<int_array_tag *>(other.value.at(i)))
+					return false;
+				break;
 			case generic_tag::BYTE:
 				if(*static_cast<byte_tag *>(value.at(i)) != *static_cast<byte_tag *>(other.value.at(i)))
 					return false;
@@ -132,8 +138,8 @@ std::string list_tag::to_string(void) {
 
 	// create string representation
 	ss << generic_tag::type_to_string(type);
-	if(!name.empty())
-		ss << " " << name;
+	if(name != tag_name_pool::EMPTY)
+		ss << " " << get_name();
 	ss << " (" << value.size() << ")";
 	if(!value.empty()) {
 		ss << " {" << std::endl;
@@ -26,30 +26,42 @@
 class list_tag : public generic_tag {
 public:
 
+	/*
+	 * List tag element type
+	 * (kept for empty lists, whose elements cannot be inspected)
+	 */
+	char element;
+
 	/*
 	 * List tag value
 	 */
-	std::vector<generic_tag *> value;
+	std::vector<generic_tag *, tag_allocator<generic_tag *> > value;
+
+	/*
+	 * List tag constructor
+	 */
+	list_tag(void) : generic_tag(LIST), element(END) { return; }
 
 	/*
 	 * List tag constructor
 	 */
-	list_tag(void) : generic_tag(LIST) { return; }
+	list_tag(const list_tag &other) : generic_tag(other), element(other.element), value(other.value) { return; }
 
 	/*
 	 * List tag constructor
 	 */
-	list_tag(const list_tag &other) : generic_tag(other.name, LIST), value(other.value) { return; }
+	list_tag(std::vector<generic_tag *> value) : generic_tag(LIST), element(END), value(value.begin(), value.end()) { return; }
 
 	/*
 	 * List tag constructor
 	 */
-	list_tag(std::vector<generic_tag *> value) : generic_tag(LIST), value(value) { return; }
+	list_tag(const std::string &name, std::vector<generic_tag *> &value) : generic_tag(name, LIST), element(END), value(value.begin(), value.end()) { return; }
 
 	/*
 	 * List tag constructor
+	 * (empty, name is a pooled name id, allocated from arena, if any)
 	 */
-	list_tag(const std::string &name, std::vector<generic_tag *> &value) : generic_tag(name, LIST), value(value) { return; }
+	list_tag(uint32_t name, tag_arena *arena) : generic_tag(name, LIST, arena), element(END), value(tag_allocator<generic_tag *>(arena)) { return; }
 
 	/*
 	 * List tag destructor
@@ -86,11 +98,22 @@ public:
 	 */
 	bool empty(void) { return value.empty(); }
 
+	/*
+	 * Returns a list tags element type
+	 * (the first elements type, or the stored type of an empty list)
+	 */
+	char get_element_type(void) { return value.empty() ? element : value.front()->get_type(); }
+
 	/*
 	 * Returns a list tag value
 	 */
 	void *get_value(void) { return &value; }
 
+	/*
+	 * Sets a list tags element type
+	 */
+	void set_element_type(char element) { this->element = element; }
+
 	/*
 	 * Returns the size of a list tag
 	 */
@@ -38,7 +38,7 @@ public:
 	/*
 	 * Long tag constructor
 	 */
-	long_tag(const long_tag &other) : generic_tag(other.name, LONG), value(other.value) { return; }
+	long_tag(const long_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * Long tag constructor
@@ -50,6 +50,12 @@ public:
 	 */
 	long_tag(const std::string &name, int64_t value) : generic_tag(name, LONG), value(value) { return; }
 
+	/*
+	 * Long tag constructor
+	 * (name is a pooled name id, allocated from arena, if any)
+	 */
+	long_tag(uint32_t name, int64_t value, tag_arena *arena) : generic_tag(name, LONG, arena), value(value) { return; }
+
 	/*
 	 * Long tag destructor
 	 */
@@ -38,7 +38,7 @@ public:
 	/*
 	 * Short tag constructor
 	 */
-	short_tag(const short_tag &other) : generic_tag(other.name, SHORT), value(other.value) { return; }
+	short_tag(const short_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * Short tag constructor
@@ -50,6 +50,12 @@ public:
 	 */
 	short_tag(const std::string &name, int16_t value) : generic_tag(name, SHORT), value(value) { return; }
 
+	/*
+	 * Short tag constructor
+	 * (name is a pooled name id, allocated from arena, if any)
+	 */
+	short_tag(uint32_t name, int16_t value, tag_arena *arena) : generic_tag(name, SHORT, arena), value(value) { return; }
+
 	/*
 	 * Short tag destructor
 	 */
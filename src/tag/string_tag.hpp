@@ -29,7 +29,7 @@ public:
 	/*
 	 * String tag value
 	 */
-	std::string value;
+	tag_string value;
 
 	/*
 	 * String tag constructor
@@ -39,17 +39,24 @@ public:
 	/*
 	 * String tag constructor
 	 */
-	string_tag(const string_tag &other) : generic_tag(other.name, STRING), value(other.value) { return; }
+	string_tag(const string_tag &other) : generic_tag(other), value(other.value) { return; }
 
 	/*
 	 * String tag constructor
 	 */
-	string_tag(const std::string &value) : generic_tag(STRING), value(value) { return; }
+	string_tag(const std::string &value) : generic_tag(STRING), value(value.data(), value.size()) { return; }
 
 	/*
 	 * String tag constructor
 	 */
-	string_tag(const std::string &name, const std::string &value) : generic_tag(name, STRING), value(value) { return; }
+	string_tag(const std::string &name, const std::string &value) : generic_tag(name, STRING), value(value.data(), value.size()) { return; }
+
+	/*
+	 * String tag constructor
+	 * (name is a pooled name id, allocated from arena, if any)
+	 */
+	string_tag(uint32_t name, const std::string &value, tag_arena *arena) : generic_tag(name, STRING, arena),
+			value(value.data(), value.size(), tag_allocator<char>(arena)) { return; }
 
 	/*
 	 * String tag destructor
@@ -0,0 +1,77 @@
+/*
+ * tag_arena.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include "tag_arena.hpp"
+
+/*
+ * Allocates size bytes from the arena
+ */
+void *tag_arena::allocate(uint64_t size) {
+	int8_t *block;
+
+	// round up to keep every allocation aligned
+	size = (size + ALIGNMENT - 1) & ~((uint64_t) ALIGNMENT - 1);
+	if(!size)
+		size = ALIGNMENT;
+	used += size;
+
+	// large allocations get a block of their own (the current block is kept)
+	if(size > BLOCK_CAPACITY / 4) {
+		block = static_cast<int8_t *>(::operator new(size));
+		blocks.insert(blocks.end() - (blocks.empty() ? 0 : 1), block);
+		reserved += size;
+		return block;
+	}
+
+	// start a new block once the current block is full
+	if(len - pos < size) {
+		blocks.push_back(static_cast<int8_t *>(::operator new(BLOCK_CAPACITY)));
+		pos = 0;
+		len = BLOCK_CAPACITY;
+		reserved += BLOCK_CAPACITY;
+	}
+	block = blocks.back() + pos;
+	pos += size;
+	return block;
+}
+
+/*
+ * Frees every allocation made from the arena at once
+ */
+void tag_arena::release(void) {
+	for(unsigned int i = 0; i < blocks.size(); ++i)
+		::operator delete(blocks.at(i));
+	blocks.clear();
+	pos = 0;
+	len = 0;
+	used = 0;
+	reserved = 0;
+}
+
+/*
+ * Returns a string representation of a tag arena
+ */
+std::string tag_arena::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[ARENA] blocks: " << blocks.size() << ", size: " << used << ", capacity: " << reserved;
+	return ss.str();
+}
@@ -0,0 +1,189 @@
+/*
+ * tag_arena.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAG_ARENA_HPP_
+#define TAG_ARENA_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+
+class tag_arena {
+private:
+
+	/*
+	 * Arena blocks
+	 * (the last block is the one being bump-allocated from)
+	 */
+	std::vector<int8_t *> blocks;
+
+	/*
+	 * Current block position/length
+	 */
+	uint64_t pos, len;
+
+	/*
+	 * Bytes allocated/reserved from the arena
+	 */
+	uint64_t used, reserved;
+
+	/*
+	 * Tag arena constructor
+	 * (arenas own their blocks and are not copyable)
+	 */
+	tag_arena(const tag_arena &other);
+
+	/*
+	 * Tag arena assignment
+	 */
+	tag_arena &operator=(const tag_arena &other);
+
+public:
+
+	/*
+	 * Arena block size
+	 * (allocations over a quarter block get a block of their own)
+	 */
+	static const unsigned int BLOCK_CAPACITY = 65536;
+
+	/*
+	 * Arena allocation alignment
+	 */
+	static const unsigned int ALIGNMENT = 16;
+
+	/*
+	 * Tag arena constructor
+	 */
+	tag_arena(void) : pos(0), len(0), used(0), reserved(0) { return; }
+
+	/*
+	 * Tag arena destructor
+	 */
+	virtual ~tag_arena(void) { release(); }
+
+	/*
+	 * Allocates size bytes from the arena
+	 * (memory is only returned when the arena is released)
+	 */
+	void *allocate(uint64_t size);
+
+	/*
+	 * Returns the bytes reserved by the arena
+	 */
+	uint64_t capacity(void) { return reserved; }
+
+	/*
+	 * Returns the empty status of the arena
+	 */
+	bool empty(void) { return !used; }
+
+	/*
+	 * Frees every allocation made from the arena at once
+	 */
+	void release(void);
+
+	/*
+	 * Returns the bytes allocated from the arena
+	 */
+	uint64_t size(void) { return used; }
+
+	/*
+	 * Returns a string representation of a tag arena
+	 */
+	std::string to_string(void);
+};
+
+/*
+ * Container allocator drawing from a tag arena
+ * (falls back to the heap without an arena)
+ */
+template <class T>
+class tag_allocator {
+public:
+
+	typedef T value_type;
+
+	/*
+	 * Source arena
+	 * (NULL for heap allocations)
+	 */
+	tag_arena *arena;
+
+	/*
+	 * Tag allocator constructor
+	 */
+	tag_allocator(void) : arena(NULL) { return; }
+
+	/*
+	 * Tag allocator constructor
+	 */
+	tag_allocator(tag_arena *arena) : arena(arena) { return; }
+
+	/*
+	 * Tag allocator constructor
+	 */
+	template <class U>
+	tag_allocator(const tag_allocator<U> &other) : arena(other.arena) { return; }
+
+	/*
+	 * Tag allocator equals
+	 */
+	template <class U>
+	bool operator==(const tag_allocator<U> &other) const { return arena == other.arena; }
+
+	/*
+	 * Tag allocator not equals
+	 */
+	template <class U>
+	bool operator!=(const tag_allocator<U> &other) const { return arena != other.arena; }
+
+	/*
+	 * Allocates room for count values
+	 */
+	T *allocate(size_t count) {
+		if(arena)
+			return static_cast<T *>(arena->allocate(count * sizeof(T)));
+		return static_cast<T *>(::operator new(count * sizeof(T)));
+	}
+
+	/*
+	 * Frees room for count values
+	 * (arena memory is returned when the arena is released)
+	 */
+	void deallocate(T *ptr, size_t) {
+		if(!arena)
+			::operator delete(ptr);
+	}
+
+	/*
+	 * Returns the allocator used by container copies
+	 * (copies are heap allocated, so they may outlive the arena)
+	 */
+	tag_allocator select_on_container_copy_construction(void) const { return tag_allocator(); }
+};
+
+/*
+ * Tag string
+ * (string values, allocated from the owning chunks arena)
+ */
+typedef std::basic_string<char, std::char_traits<char>, tag_allocator<char> > tag_string;
+
+#endif
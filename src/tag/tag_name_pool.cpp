@@ -0,0 +1,219 @@
+/*
+ * tag_name_pool.cpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <stdexcept>
+#include "tag_name_pool.hpp"
+
+/*
+ * Name ids
+ */
+const uint32_t tag_name_pool::EMPTY;
+const uint32_t tag_name_pool::NONE;
+
+/*
+ * First block of pooled names
+ */
+tag_name_pool::entry tag_name_pool::first[tag_name_pool::BLOCK_LENGTH] = { { "", 0 } };
+
+/*
+ * Pooled names
+ */
+tag_name_pool::entry *tag_name_pool::blocks[tag_name_pool::BLOCK_COUNT] = { first };
+
+/*
+ * Pooled name count
+ */
+uint32_t tag_name_pool::count = 1;
+
+/*
+ * Name ids by hash slot
+ */
+uint32_t *tag_name_pool::table = NULL;
+
+/*
+ * Hash slot count
+ */
+uint32_t tag_name_pool::capacity = 0;
+
+/*
+ * Guards additions to the pool
+ */
+std::mutex tag_name_pool::lock;
+
+/*
+ * Returns the id of a pooled name
+ */
+uint32_t tag_name_pool::find(const std::string &name) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	// the empty name is never hashed
+	if(name.empty())
+		return EMPTY;
+	if(!capacity)
+		return NONE;
+	uint32_t id = table[find_slot(name.data(), name.size(), hash(name.data(), name.size()))];
+	return id == EMPTY ? NONE : id;
+}
+
+/*
+ * Returns the hash slot of a name
+ */
+uint32_t tag_name_pool::find_slot(const char *name, uint64_t len, uint32_t hash) {
+	uint32_t slot = hash & (capacity - 1);
+
+	// probe until the name or an unused slot is found
+	while(table[slot] != EMPTY
+			&& !equals(table[slot], name, len))
+		slot = (slot + 1) & (capacity - 1);
+	return slot;
+}
+
+/*
+ * Doubles the hash slot count
+ */
+void tag_name_pool::grow(void) {
+	uint32_t *old_table = table, old_capacity = capacity;
+
+	// rehash pooled names into the new table
+	capacity = capacity ? capacity * 2 : 1024;
+	table = new uint32_t[capacity]();
+	for(uint32_t i = 0; i < old_capacity; ++i)
+		if(old_table[i] != EMPTY) {
+			const entry &ent = blocks[old_table[i] / BLOCK_LENGTH][old_table[i] % BLOCK_LENGTH];
+			table[find_slot(ent.data, ent.len, hash(old_table[i]))] = old_table[i];
+		}
+	delete[] old_table;
+}
+
+/*
+ * Returns the hash of a name
+ * (FNV-1a)
+ */
+uint32_t tag_name_pool::hash(const char *name, uint64_t len) {
+	uint32_t result = 2166136261u;
+
+	for(uint64_t i = 0; i < len; ++i)
+		result = (result ^ (uint8_t) name[i]) * 16777619u;
+	return result;
+}
+
+/*
+ * Returns the hash of a pooled name
+ */
+uint32_t tag_name_pool::hash(uint32_t id) {
+	const entry &ent = blocks[id / BLOCK_LENGTH][id % BLOCK_LENGTH];
+
+	return hash(ent.data, ent.len);
+}
+
+/*
+ * Returns the id of a name, pooling it on first use
+ */
+uint32_t tag_name_pool::intern(const char *name, uint64_t len) {
+	uint32_t slot, id, hash_val;
+
+	// the empty name is never hashed
+	if(!len)
+		return EMPTY;
+	hash_val = hash(name, len);
+	std::lock_guard<std::mutex> guard(lock);
+
+	// check for a pooled name (keeping the table under half full)
+	if(count >= capacity / 2)
+		grow();
+	slot = find_slot(name, len, hash_val);
+	if(table[slot] != EMPTY)
+		return table[slot];
+
+	// pool name under the next id
+	if(count >= BLOCK_COUNT * BLOCK_LENGTH)
+		throw std::length_error("tag name pool is full");
+	id = count;
+	if(!blocks[id / BLOCK_LENGTH])
+		blocks[id / BLOCK_LENGTH] = new entry[BLOCK_LENGTH];
+	char *data = new char[len];
+	memcpy(data, name, len);
+	blocks[id / BLOCK_LENGTH][id % BLOCK_LENGTH].data = data;
+	blocks[id / BLOCK_LENGTH][id % BLOCK_LENGTH].len = len;
+	table[slot] = id;
+	++count;
+	return id;
+}
+
+/*
+ * Returns the pooled name count
+ */
+uint32_t tag_name_pool::size(void) {
+	std::lock_guard<std::mutex> guard(lock);
+
+	return count;
+}
+
+/*
+ * Discards the cached names
+ */
+void tag_name_cache::clear(void) {
+	table.assign(DEFAULT_CAPACITY, tag_name_pool::EMPTY);
+	count = 0;
+}
+
+/*
+ * Returns the id of a name, pooling it on first use
+ */
+uint32_t tag_name_cache::intern(const char *name, uint64_t len) {
+	uint32_t id, slot, mask = table.size() - 1;
+
+	// the empty name is never hashed
+	if(!len)
+		return tag_name_pool::EMPTY;
+
+	// probe until the name or an unused slot is found
+	for(slot = tag_name_pool::hash(name, len) & mask; table[slot] != tag_name_pool::EMPTY; slot = (slot + 1) & mask)
+		if(tag_name_pool::equals(table[slot], name, len))
+			return table[slot];
+
+	// resolve name from the pool
+	id = tag_name_pool::intern(name, len);
+	table[slot] = id;
+
+	// rehash cached names once half full
+	if(++count >= table.size() / 2) {
+		std::vector<uint32_t> old_table(table.size() * 2, tag_name_pool::EMPTY);
+		old_table.swap(table);
+		mask = table.size() - 1;
+		for(uint32_t i = 0; i < old_table.size(); ++i)
+			if(old_table[i] != tag_name_pool::EMPTY) {
+				for(slot = tag_name_pool::hash(old_table[i]) & mask; table[slot] != tag_name_pool::EMPTY; slot = (slot + 1) & mask);
+				table[slot] = old_table[i];
+			}
+	}
+	return id;
+}
+
+/*
+ * Returns a string representation of a tag name cache
+ */
+std::string tag_name_cache::to_string(void) {
+	std::stringstream ss;
+
+	// form string representation
+	ss << "[NAME CACHE] size: " << count << ", capacity: " << table.size();
+	return ss.str();
+}
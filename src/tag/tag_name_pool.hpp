@@ -0,0 +1,211 @@
+/*
+ * tag_name_pool.hpp
+ * Copyright (C) 2012 David Jolly
+ * ----------------------
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TAG_NAME_POOL_HPP_
+#define TAG_NAME_POOL_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class tag_name_pool {
+private:
+
+	/*
+	 * Pooled name
+	 */
+	class entry {
+	public:
+
+		/*
+		 * Name bytes/length
+		 */
+		const char *data;
+		uint32_t len;
+	};
+
+	/*
+	 * First block of pooled names
+	 * (holds the empty name, so the pool is usable before any name is added)
+	 */
+	static entry first[];
+
+	/*
+	 * Pooled names
+	 * (blocks of BLOCK_LENGTH entries by id, never moved or freed)
+	 */
+	static entry *blocks[];
+
+	/*
+	 * Pooled name count
+	 */
+	static uint32_t count;
+
+	/*
+	 * Name ids by hash slot
+	 * (open addressing, EMPTY marks an unused slot)
+	 */
+	static uint32_t *table;
+
+	/*
+	 * Hash slot count
+	 */
+	static uint32_t capacity;
+
+	/*
+	 * Guards additions to the pool
+	 */
+	static std::mutex lock;
+
+	/*
+	 * Returns the hash slot of a name
+	 * (the slot holds EMPTY if the name is not pooled)
+	 */
+	static uint32_t find_slot(const char *name, uint64_t len, uint32_t hash);
+
+	/*
+	 * Doubles the hash slot count
+	 */
+	static void grow(void);
+
+public:
+
+	/*
+	 * Pool size
+	 */
+	static const unsigned int BLOCK_COUNT = 4096;
+	static const unsigned int BLOCK_LENGTH = 1024;
+
+	/*
+	 * Name ids
+	 * (the empty name is always pooled, NONE is never returned by intern)
+	 */
+	static const uint32_t EMPTY = 0;
+	static const uint32_t NONE = 0xffffffff;
+
+	/*
+	 * Returns true if a pooled name matches a given name
+	 */
+	static bool equals(uint32_t id, const char *name, uint64_t len) {
+		const entry &ent = blocks[id / BLOCK_LENGTH][id % BLOCK_LENGTH];
+
+		return ent.len == len && !memcmp(ent.data, name, len);
+	}
+
+	/*
+	 * Returns the id of a pooled name
+	 * (NONE if the name was never pooled)
+	 */
+	static uint32_t find(const std::string &name);
+
+	/*
+	 * Returns a pooled name
+	 */
+	static std::string get(uint32_t id) {
+		const entry &ent = blocks[id / BLOCK_LENGTH][id % BLOCK_LENGTH];
+
+		return std::string(ent.data, ent.len);
+	}
+
+	/*
+	 * Returns the hash of a name
+	 */
+	static uint32_t hash(const char *name, uint64_t len);
+
+	/*
+	 * Returns the hash of a pooled name
+	 */
+	static uint32_t hash(uint32_t id);
+
+	/*
+	 * Returns the id of a name, pooling it on first use
+	 * (ids stay valid for the life of the process)
+	 */
+	static uint32_t intern(const char *name, uint64_t len);
+
+	/*
+	 * Returns the id of a name, pooling it on first use
+	 */
+	static uint32_t intern(const std::string &name) { return intern(name.data(), name.size()); }
+
+	/*
+	 * Returns the pooled name count
+	 */
+	static uint32_t size(void);
+};
+
+/*
+ * Tag name cache
+ * (per reader, resolves repeated names without locking the pool)
+ */
+class tag_name_cache {
+private:
+
+	/*
+	 * Name ids by hash slot
+	 * (open addressing, tag_name_pool::EMPTY marks an unused slot)
+	 */
+	std::vector<uint32_t> table;
+
+	/*
+	 * Cached name count
+	 */
+	uint32_t count;
+
+public:
+
+	/*
+	 * Initial hash slot count
+	 */
+	static const unsigned int DEFAULT_CAPACITY = 256;
+
+	/*
+	 * Tag name cache constructor
+	 */
+	tag_name_cache(void) : table(DEFAULT_CAPACITY, tag_name_pool::EMPTY), count(0) { return; }
+
+	/*
+	 * Tag name cache destructor
+	 */
+	virtual ~tag_name_cache(void) { return; }
+
+	/*
+	 * Discards the cached names
+	 */
+	void clear(void);
+
+	/*
+	 * Returns the id of a name, pooling it on first use
+	 */
+	uint32_t intern(const char *name, uint64_t len);
+
+	/*
+	 * Returns the cached name count
+	 */
+	uint32_t size(void) { return count; }
+
+	/*
+	 * Returns a string representation of a tag name cache
+	 */
+	std::string to_string(void);
+};
+
+#endif